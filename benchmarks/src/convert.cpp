@@ -0,0 +1,81 @@
+#include <benchmark/benchmark.h>
+
+#include "comservatory/convert.hpp"
+#include "comservatory/input.hpp"
+
+#include <cstdio>
+#include <random>
+#include <string>
+
+// A column of numbers, each followed by a newline; 'digits' controls the
+// number of fractional digits, i.e., short (e.g., 12.5) versus full precision.
+static std::string mock_numbers(size_t n, int digits) {
+    std::mt19937_64 rng(999);
+    std::uniform_real_distribution<double> dist(-1000, 1000);
+    std::string output;
+    char buffer[64];
+    for (size_t i = 0; i < n; ++i) {
+        std::snprintf(buffer, sizeof(buffer), "%.*f\n", digits, dist(rng));
+        output += buffer;
+    }
+    return output;
+}
+
+static void BM_ToNumber(benchmark::State& state) {
+    auto buffer = mock_numbers(100000, state.range(0));
+    for (auto _ : state) {
+        comservatory::BufferInput input(buffer.data(), buffer.data() + buffer.size());
+        double total = 0;
+        size_t line = 0;
+        while (input.valid()) {
+            if (input.get() == '-') {
+                input.advance();
+                total -= comservatory::to_number(input, 0, line);
+            } else {
+                total += comservatory::to_number(input, 0, line);
+            }
+            input.advance(); // skipping the newline.
+            ++line;
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+BENCHMARK(BM_ToNumber)->Arg(1)->Arg(3)->Arg(8)->Arg(14);
+
+// A column of long quoted strings with occasional escaped quotes.
+static std::string mock_strings(size_t n, size_t length) {
+    std::mt19937_64 rng(1000);
+    std::string output;
+    for (size_t i = 0; i < n; ++i) {
+        output += '"';
+        for (size_t j = 0; j < length; ++j) {
+            if (rng() % 200 == 0) {
+                output += "\"\"";
+            } else {
+                output += static_cast<char>('a' + rng() % 26);
+            }
+        }
+        output += "\"\n";
+    }
+    return output;
+}
+
+static void BM_ToString(benchmark::State& state) {
+    auto buffer = mock_strings(2000, state.range(0));
+    std::string value;
+    for (auto _ : state) {
+        comservatory::BufferInput input(buffer.data(), buffer.data() + buffer.size());
+        size_t line = 0, total = 0;
+        while (input.valid()) {
+            value.clear();
+            comservatory::to_string(input, 0, line, value);
+            total += value.size();
+            input.advance(); // skipping the newline.
+            ++line;
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+BENCHMARK(BM_ToString)->Arg(10)->Arg(100)->Arg(5000);
@@ -0,0 +1,53 @@
+#include <benchmark/benchmark.h>
+
+#include "comservatory/comservatory.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Per-value virtual calls, as in the parser before staging.
+static void BM_PushBack(benchmark::State& state) {
+    std::vector<double> values(state.range(0));
+    for (auto _ : state) {
+        std::unique_ptr<comservatory::Field> field(new comservatory::FilledNumberField);
+        auto ptr = static_cast<comservatory::NumberField*>(field.get());
+        for (auto v : values) {
+            ptr->push_back(v);
+        }
+        benchmark::DoNotOptimize(field.get());
+    }
+    state.SetItemsProcessed(state.iterations() * values.size());
+}
+BENCHMARK(BM_PushBack)->Arg(1000000);
+
+// Batched calls with the same staging size as the parser.
+static void BM_PushBackMany(benchmark::State& state) {
+    std::vector<double> values(state.range(0));
+    constexpr size_t stage_size = 64;
+    for (auto _ : state) {
+        std::unique_ptr<comservatory::Field> field(new comservatory::FilledNumberField);
+        auto ptr = static_cast<comservatory::NumberField*>(field.get());
+        for (size_t i = 0, n = values.size(); i < n; i += stage_size) {
+            ptr->push_back_many(values.data() + i, std::min(stage_size, n - i));
+        }
+        benchmark::DoNotOptimize(field.get());
+    }
+    state.SetItemsProcessed(state.iterations() * values.size());
+}
+BENCHMARK(BM_PushBackMany)->Arg(1000000);
+
+// End-to-end parsing of a table of small numbers, where per-cell overhead dominates.
+static void BM_ReadNumbers(benchmark::State& state) {
+    std::string buffer = "\"a\",\"b\",\"c\",\"d\"\n";
+    for (size_t i = 0; i < 200000; ++i) {
+        auto x = std::to_string(i % 100);
+        buffer += x + "," + x + "," + (i % 10 ? x : std::string("NA")) + "," + x + "\n";
+    }
+    for (auto _ : state) {
+        auto contents = comservatory::read_buffer(buffer.data(), buffer.size(), comservatory::ReadOptions());
+        benchmark::DoNotOptimize(contents.fields.data());
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+BENCHMARK(BM_ReadNumbers);
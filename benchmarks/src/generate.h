@@ -0,0 +1,222 @@
+#ifndef GENERATE_H
+#define GENERATE_H
+
+#include <random>
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <filesystem>
+
+#include "zlib.h"
+
+// Shapes of the synthetic tables, chosen to stress different parts of the parser.
+enum class MockShape : int {
+    WIDE,     // many fields of mixed types, few records.
+    LONG,     // few fields of mixed types, many records.
+    STRINGS,  // quoted strings with embedded commas, newlines and escaped quotes.
+    NUMBERS,  // integers, decimals and scientific notation.
+    COMPLEX,  // complex numbers.
+    BOOLEANS, // booleans in all supported capitalizations.
+    MISSING   // mixed types where most values are missing.
+};
+
+constexpr int num_mock_shapes = 7;
+
+inline const char* mock_shape_name(MockShape shape) {
+    switch (shape) {
+        case MockShape::WIDE: return "wide";
+        case MockShape::LONG: return "long";
+        case MockShape::STRINGS: return "strings";
+        case MockShape::NUMBERS: return "numbers";
+        case MockShape::COMPLEX: return "complex";
+        case MockShape::BOOLEANS: return "booleans";
+        case MockShape::MISSING: return "missing";
+    }
+    return "";
+}
+
+// Deterministic generator of CSV values of each type.
+class MockGenerator {
+public:
+    MockGenerator(uint64_t seed) : rng(seed) {}
+
+    std::string number() {
+        switch (rng() % 3) {
+            case 0:
+                return std::to_string(static_cast<int64_t>(rng() % 2000000) - 1000000);
+            case 1:
+                return fixed(rng() % 8 + 1);
+            default:
+                {
+                    // Mantissa must be in [1, 10) in scientific notation.
+                    std::string output = (rng() % 2 ? "-" : "");
+                    output += static_cast<char>('1' + rng() % 9);
+                    output += '.';
+                    for (int d = rng() % 6 + 1; d > 0; --d) {
+                        output += static_cast<char>('0' + rng() % 10);
+                    }
+                    return output + "e" + std::to_string(static_cast<int>(rng() % 40) - 20);
+                }
+        }
+    }
+
+    std::string complex() {
+        auto imag = fixed(rng() % 6 + 1);
+        return fixed(rng() % 6 + 1) + (imag[0] == '-' ? "" : "+") + imag + "i";
+    }
+
+    std::string boolean() {
+        static const char* choices[] = { "true", "false", "TRUE", "FALSE", "True", "False" };
+        return choices[rng() % 6];
+    }
+
+    std::string string() {
+        static const char alphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789   ";
+        size_t len = rng() % 30;
+        std::string output = "\"";
+        for (size_t i = 0; i < len; ++i) {
+            auto roll = rng() % 100;
+            if (roll == 0) {
+                output += "\"\"";
+            } else if (roll == 1) {
+                output += '\n';
+            } else if (roll < 5) {
+                output += ',';
+            } else {
+                output += alphabet[rng() % (sizeof(alphabet) - 1)];
+            }
+        }
+        output += "\"";
+        return output;
+    }
+
+    std::string value(int type) {
+        switch (type) {
+            case 0: return number();
+            case 1: return string();
+            case 2: return boolean();
+            default: return complex();
+        }
+    }
+
+    bool chance(int percent) {
+        return static_cast<int>(rng() % 100) < percent;
+    }
+
+private:
+    std::string fixed(int digits) {
+        char buffer[64];
+        double val = static_cast<double>(static_cast<int64_t>(rng() % 2000000000) - 1000000000) / 1000000;
+        std::snprintf(buffer, sizeof(buffer), "%.*f", digits, val);
+        return buffer;
+    }
+
+    std::mt19937_64 rng;
+};
+
+struct MockTable {
+    std::string contents;
+    size_t nrecords = 0;
+    size_t nfields = 0;
+};
+
+inline MockTable generate_table(MockShape shape) {
+    MockTable output;
+    std::vector<int> types; // 0 = number, 1 = string, 2 = boolean, 3 = complex.
+    int missing = 0;
+
+    switch (shape) {
+        case MockShape::WIDE:
+            output.nrecords = 2000;
+            for (int i = 0; i < 500; ++i) {
+                types.push_back(i % 4);
+            }
+            break;
+        case MockShape::LONG:
+            output.nrecords = 500000;
+            types = { 0, 1, 2, 0 };
+            break;
+        case MockShape::STRINGS:
+            output.nrecords = 50000;
+            types.resize(10, 1);
+            break;
+        case MockShape::NUMBERS:
+            output.nrecords = 50000;
+            types.resize(20, 0);
+            break;
+        case MockShape::COMPLEX:
+            output.nrecords = 50000;
+            types.resize(10, 3);
+            break;
+        case MockShape::BOOLEANS:
+            output.nrecords = 100000;
+            types.resize(20, 2);
+            break;
+        case MockShape::MISSING:
+            output.nrecords = 100000;
+            types = { 0, 1, 2, 3, 0, 1, 2, 3 };
+            missing = 80;
+            break;
+    }
+    output.nfields = types.size();
+
+    MockGenerator gen(static_cast<uint64_t>(shape) + 12345);
+    auto& x = output.contents;
+    for (size_t f = 0; f < types.size(); ++f) {
+        x += (f ? ",\"field" : "\"field") + std::to_string(f) + "\"";
+    }
+    x += '\n';
+
+    for (size_t r = 0; r < output.nrecords; ++r) {
+        for (size_t f = 0; f < types.size(); ++f) {
+            if (f) {
+                x += ',';
+            }
+            if (missing && gen.chance(missing)) {
+                x += "NA";
+            } else {
+                x += gen.value(types[f]);
+            }
+        }
+        x += '\n';
+    }
+
+    return output;
+}
+
+// Tables are generated once and cached, along with their files.
+inline const MockTable& mock_table(MockShape shape) {
+    static std::map<MockShape, MockTable> cache;
+    auto it = cache.find(shape);
+    if (it == cache.end()) {
+        it = cache.insert(std::make_pair(shape, generate_table(shape))).first;
+    }
+    return it->second;
+}
+
+inline std::string mock_table_path(MockShape shape, bool gzipped) {
+    static std::map<std::pair<MockShape, bool>, std::string> cache;
+    auto key = std::make_pair(shape, gzipped);
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+        return it->second;
+    }
+
+    std::string path = (std::filesystem::temp_directory_path() / (std::string("comservatory-bench-") + mock_shape_name(shape) + ".csv")).string();
+    const auto& contents = mock_table(shape).contents;
+    if (gzipped) {
+        path += ".gz";
+        gzFile handle = gzopen(path.c_str(), "wb");
+        gzwrite(handle, contents.data(), contents.size());
+        gzclose(handle);
+    } else {
+        std::ofstream out(path, std::ios::binary);
+        out << contents;
+    }
+
+    cache[key] = path;
+    return path;
+}
+
+#endif
@@ -0,0 +1,54 @@
+#include <benchmark/benchmark.h>
+
+#include "comservatory/comservatory.hpp"
+#include "byteme/byteme.hpp"
+
+#include "mock_table.h"
+
+// Parsing through byteme's BufferedReader, which copies the data and checks for refills.
+static void BM_ReadBuffered(benchmark::State& state) {
+    const auto& buffer = mock_buffer();
+    for (auto _ : state) {
+        byteme::RawBufferReader reader(reinterpret_cast<const unsigned char*>(buffer.data()), buffer.size());
+        auto contents = comservatory::read(reader, comservatory::ReadOptions());
+        benchmark::DoNotOptimize(contents.fields.data());
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+BENCHMARK(BM_ReadBuffered);
+
+// Parsing directly from the contiguous buffer.
+static void BM_ReadContiguous(benchmark::State& state) {
+    const auto& buffer = mock_buffer();
+    for (auto _ : state) {
+        auto contents = comservatory::read_buffer(buffer.data(), buffer.size(), comservatory::ReadOptions());
+        benchmark::DoNotOptimize(contents.fields.data());
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+BENCHMARK(BM_ReadContiguous);
+
+static void BM_ValidateBuffered(benchmark::State& state) {
+    const auto& buffer = mock_buffer();
+    comservatory::ReadOptions opt;
+    opt.validate_only = true;
+    for (auto _ : state) {
+        byteme::RawBufferReader reader(reinterpret_cast<const unsigned char*>(buffer.data()), buffer.size());
+        auto contents = comservatory::read(reader, opt);
+        benchmark::DoNotOptimize(contents.fields.data());
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+BENCHMARK(BM_ValidateBuffered);
+
+static void BM_ValidateContiguous(benchmark::State& state) {
+    const auto& buffer = mock_buffer();
+    comservatory::ReadOptions opt;
+    opt.validate_only = true;
+    for (auto _ : state) {
+        auto contents = comservatory::read_buffer(buffer.data(), buffer.size(), opt);
+        benchmark::DoNotOptimize(contents.fields.data());
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+BENCHMARK(BM_ValidateContiguous);
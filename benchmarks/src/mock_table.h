@@ -0,0 +1,24 @@
+#ifndef MOCK_TABLE_H
+#define MOCK_TABLE_H
+
+#include <random>
+#include <string>
+
+inline std::string mock_table(size_t nrecords) {
+    std::mt19937_64 rng(12345);
+    std::string output = "\"id\",\"score\",\"label\",\"flag\"\n";
+    for (size_t r = 0; r < nrecords; ++r) {
+        output += std::to_string(r) + ",";
+        output += std::to_string(static_cast<double>(rng() % 1000000) / 1000) + ",";
+        output += "\"label " + std::to_string(rng() % 1000) + ", with \"\"quotes\"\"\",";
+        output += (rng() % 2 ? "TRUE\n" : "false\n");
+    }
+    return output;
+}
+
+inline const std::string& mock_buffer() {
+    static const std::string buffer = mock_table(200000);
+    return buffer;
+}
+
+#endif
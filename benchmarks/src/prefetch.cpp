@@ -0,0 +1,57 @@
+#include <benchmark/benchmark.h>
+
+#include "comservatory/comservatory.hpp"
+#include "byteme/byteme.hpp"
+
+#include "mock_table.h"
+
+#include <string>
+#include <fstream>
+#include <filesystem>
+
+#include "zlib.h"
+
+static const std::string& mock_file(bool gzipped) {
+    static const std::string raw = [&]() -> std::string {
+        auto path = (std::filesystem::temp_directory_path() / "comservatory-bench-prefetch.csv").string();
+        std::ofstream out(path, std::ios::binary);
+        out << mock_buffer();
+        return path;
+    }();
+
+    static const std::string gz = [&]() -> std::string {
+        auto path = (std::filesystem::temp_directory_path() / "comservatory-bench-prefetch.csv.gz").string();
+        const auto& buffer = mock_buffer();
+        gzFile handle = gzopen(path.c_str(), "wb");
+        gzwrite(handle, buffer.data(), buffer.size());
+        gzclose(handle);
+        return path;
+    }();
+
+    return (gzipped ? gz : raw);
+}
+
+// The first argument specifies the prefetch depth, where 0 disables reading ahead.
+static void run_prefetch(benchmark::State& state, bool gzipped) {
+    const auto& path = mock_file(gzipped);
+    comservatory::ReadOptions opt;
+    opt.parallel = (state.range(0) > 0);
+    opt.prefetch_depth = state.range(0);
+    opt.buffer_size = state.range(1);
+
+    for (auto _ : state) {
+        auto contents = comservatory::read_file(path, opt);
+        benchmark::DoNotOptimize(contents.fields.data());
+    }
+    state.SetBytesProcessed(state.iterations() * mock_buffer().size());
+}
+
+static void BM_PrefetchRaw(benchmark::State& state) {
+    run_prefetch(state, false);
+}
+BENCHMARK(BM_PrefetchRaw)->ArgsProduct({ { 0, 1, 2, 4 }, { 65536, 1 << 20 } });
+
+static void BM_PrefetchGzip(benchmark::State& state) {
+    run_prefetch(state, true);
+}
+BENCHMARK(BM_PrefetchGzip)->ArgsProduct({ { 0, 1, 2, 4 }, { 65536, 1 << 20 } });
@@ -0,0 +1,118 @@
+#include <benchmark/benchmark.h>
+
+#include "comservatory/comservatory.hpp"
+#include "comservatory/scan.hpp"
+#include "byteme/byteme.hpp"
+
+#include "mock_table.h"
+
+#include <string>
+#include <vector>
+
+// Mimics the per-byte access pattern of Parser::parse_loop,
+// where each byte is fetched, checked for validity and branched on.
+static void BM_ByteLoop(benchmark::State& state) {
+    const auto& buffer = mock_buffer();
+    for (auto _ : state) {
+        byteme::RawBufferReader reader(reinterpret_cast<const unsigned char*>(buffer.data()), buffer.size());
+        byteme::SerialBufferedReader<char, byteme::Reader*> input(&reader, 65536);
+        size_t boundaries = 0;
+        bool in_quotes = false;
+        while (input.valid()) {
+            char c = input.get();
+            if (c == '"') {
+                in_quotes = !in_quotes;
+            } else if (!in_quotes && (c == ',' || c == '\n')) {
+                ++boundaries;
+            }
+            input.advance();
+        }
+        benchmark::DoNotOptimize(boundaries);
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+BENCHMARK(BM_ByteLoop);
+
+static void BM_StructuralScan(benchmark::State& state) {
+    const auto& buffer = mock_buffer();
+    std::vector<size_t> boundaries;
+    for (auto _ : state) {
+        boundaries.clear();
+        comservatory::find_boundaries(buffer.data(), buffer.size(), boundaries);
+        benchmark::DoNotOptimize(boundaries.data());
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+BENCHMARK(BM_StructuralScan);
+
+static void BM_CountRecords(benchmark::State& state) {
+    const auto& buffer = mock_buffer();
+    for (auto _ : state) {
+        auto n = comservatory::count_records(buffer.data(), buffer.data() + buffer.size());
+        benchmark::DoNotOptimize(n);
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+BENCHMARK(BM_CountRecords);
+
+static void BM_FullRead(benchmark::State& state) {
+    const auto& buffer = mock_buffer();
+    for (auto _ : state) {
+        byteme::RawBufferReader reader(reinterpret_cast<const unsigned char*>(buffer.data()), buffer.size());
+        auto contents = comservatory::read(reader, comservatory::ReadOptions());
+        benchmark::DoNotOptimize(contents.fields.data());
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+BENCHMARK(BM_FullRead);
+
+static void BM_FullReadBuffer(benchmark::State& state) {
+    const auto& buffer = mock_buffer();
+    for (auto _ : state) {
+        auto contents = comservatory::read_buffer(buffer.data(), buffer.size(), comservatory::ReadOptions());
+        benchmark::DoNotOptimize(contents.fields.data());
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+BENCHMARK(BM_FullReadBuffer);
+
+static void BM_TypedReadBuffer(benchmark::State& state) {
+    const auto& buffer = mock_buffer();
+    for (auto _ : state) {
+        auto contents = comservatory::read_typed_buffer<comservatory::NUMBER, comservatory::NUMBER, comservatory::STRING, comservatory::BOOLEAN>(buffer.data(), buffer.size());
+        benchmark::DoNotOptimize(std::get<0>(contents.fields).values.data());
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+BENCHMARK(BM_TypedReadBuffer);
+
+static void BM_VisitBuffer(benchmark::State& state) {
+    const auto& buffer = mock_buffer();
+    struct Summer : public comservatory::Visitor {
+        void number(size_t, double value) {
+            total += value;
+        }
+        double total = 0;
+    };
+    for (auto _ : state) {
+        Summer summer;
+        comservatory::visit_buffer(buffer.data(), buffer.size(), summer, comservatory::ReadOptions());
+        benchmark::DoNotOptimize(summer.total);
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+BENCHMARK(BM_VisitBuffer);
+
+static void BM_KeepSubset(benchmark::State& state) {
+    const auto& buffer = mock_buffer();
+    comservatory::ReadOptions opt;
+    opt.keep_subset = true;
+    opt.keep_subset_indices = std::vector<int>{ 0 };
+    opt.dummy_validation = static_cast<comservatory::ValidationLevel>(state.range(0));
+    for (auto _ : state) {
+        auto contents = comservatory::read_buffer(buffer.data(), buffer.size(), opt);
+        benchmark::DoNotOptimize(contents.fields.data());
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+BENCHMARK(BM_KeepSubset)->Arg(0)->Arg(1)->Arg(2);
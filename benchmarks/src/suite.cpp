@@ -0,0 +1,93 @@
+#include <benchmark/benchmark.h>
+
+#include "comservatory/comservatory.hpp"
+#include "byteme/byteme.hpp"
+
+#include "generate.h"
+
+// Each benchmark is run for every shape of table in generate.h, reporting
+// throughput in both bytes and records per second.
+static void report(benchmark::State& state, const MockTable& table) {
+    state.SetLabel(mock_shape_name(static_cast<MockShape>(state.range(0))));
+    state.SetBytesProcessed(state.iterations() * table.contents.size());
+    state.counters["records_per_second"] = benchmark::Counter(static_cast<double>(state.iterations() * table.nrecords), benchmark::Counter::kIsRate);
+}
+
+static void BM_SuiteRead(benchmark::State& state) {
+    const auto& table = mock_table(static_cast<MockShape>(state.range(0)));
+    const auto& x = table.contents;
+    for (auto _ : state) {
+        byteme::RawBufferReader reader(reinterpret_cast<const unsigned char*>(x.data()), x.size());
+        auto contents = comservatory::read(reader, comservatory::ReadOptions());
+        benchmark::DoNotOptimize(contents.fields.data());
+    }
+    report(state, table);
+}
+BENCHMARK(BM_SuiteRead)->DenseRange(0, num_mock_shapes - 1);
+
+static void BM_SuiteReadFile(benchmark::State& state) {
+    auto shape = static_cast<MockShape>(state.range(0));
+    const auto& table = mock_table(shape);
+    auto path = mock_table_path(shape, false);
+    for (auto _ : state) {
+        auto contents = comservatory::read_file(path, comservatory::ReadOptions());
+        benchmark::DoNotOptimize(contents.fields.data());
+    }
+    report(state, table);
+}
+BENCHMARK(BM_SuiteReadFile)->DenseRange(0, num_mock_shapes - 1);
+
+static void BM_SuiteValidate(benchmark::State& state) {
+    const auto& table = mock_table(static_cast<MockShape>(state.range(0)));
+    const auto& x = table.contents;
+    comservatory::ReadOptions opt;
+    opt.validate_only = true;
+    for (auto _ : state) {
+        auto contents = comservatory::read_buffer(x.data(), x.size(), opt);
+        benchmark::DoNotOptimize(contents.fields.data());
+    }
+    report(state, table);
+}
+BENCHMARK(BM_SuiteValidate)->DenseRange(0, num_mock_shapes - 1);
+
+// Only keeping the first field, so that the rest are only validated.
+static void BM_SuiteKeepSubset(benchmark::State& state) {
+    const auto& table = mock_table(static_cast<MockShape>(state.range(0)));
+    const auto& x = table.contents;
+    comservatory::ReadOptions opt;
+    opt.keep_subset = true;
+    opt.keep_subset_indices.push_back(0);
+    for (auto _ : state) {
+        auto contents = comservatory::read_buffer(x.data(), x.size(), opt);
+        benchmark::DoNotOptimize(contents.fields.data());
+    }
+    report(state, table);
+}
+BENCHMARK(BM_SuiteKeepSubset)->DenseRange(0, num_mock_shapes - 1);
+
+static void BM_SuiteGzip(benchmark::State& state) {
+    auto shape = static_cast<MockShape>(state.range(0));
+    const auto& table = mock_table(shape);
+    auto path = mock_table_path(shape, true);
+    for (auto _ : state) {
+        auto contents = comservatory::read_file(path, comservatory::ReadOptions());
+        benchmark::DoNotOptimize(contents.fields.data());
+    }
+    report(state, table);
+}
+BENCHMARK(BM_SuiteGzip)->DenseRange(0, num_mock_shapes - 1);
+
+// Formatting the parsed table back into CSV, in memory.
+static void BM_SuiteWrite(benchmark::State& state) {
+    const auto& table = mock_table(static_cast<MockShape>(state.range(0)));
+    const auto& x = table.contents;
+    auto contents = comservatory::read_buffer(x.data(), x.size(), comservatory::ReadOptions());
+    comservatory::WriteOptions opt;
+    opt.num_threads = state.range(1);
+    for (auto _ : state) {
+        auto output = comservatory::write_buffer(contents, opt);
+        benchmark::DoNotOptimize(output.data());
+    }
+    report(state, table);
+}
+BENCHMARK(BM_SuiteWrite)->ArgsProduct({ benchmark::CreateDenseRange(0, num_mock_shapes - 1, 1), { 1, 4 } });
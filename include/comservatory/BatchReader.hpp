@@ -0,0 +1,179 @@
+#ifndef COMSERVATORY_BATCHREADER_HPP
+#define COMSERVATORY_BATCHREADER_HPP
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <stdexcept>
+#include <algorithm>
+
+#include "Type.hpp"
+#include "Field.hpp"
+#include "Creator.hpp"
+#include "Parser.hpp"
+#include "read.hpp"
+#include "PrefetchReader.hpp"
+
+#include "byteme/byteme.hpp"
+
+/**
+ * @file BatchReader.hpp
+ *
+ * @brief Defines the `BatchReader` class for reading a CSV file in batches of records.
+ */
+
+namespace comservatory {
+
+/**
+ * @brief Read a CSV file in batches of records.
+ *
+ * @tparam Reader A reader class that implements the same methods as `bytme::Reader`.
+ *
+ * Each call to `next()` parses up to a fixed number of records into a `Contents` object, so that peak memory usage does not depend on the size of the file.
+ * The same validation is performed as in `read()`, including the checks for consistent types across all records in the file.
+ * The type of each field is carried across batches, so a field that contains only missing values in the earlier batches is represented by an `UnknownField` until its type is resolved in a later batch.
+ * Similarly, if `ReadOptions::detect_integers = true`, an `INTEGER` field in earlier batches may be reported as a `NUMBER` field in later batches.
+ */
+template<class Reader>
+class BatchReader {
+public:
+    /**
+     * @param reader Instance of a `Reader` class, containing the data stream for a CSV file.
+     * This should outlive the `BatchReader`.
+     * @param batch_size Maximum number of records in each batch.
+     * @param options Reading options.
+     * `ReadOptions::num_threads`, `ReadOptions::memory_map`, `ReadOptions::string_views`, `ReadOptions::record_index`, `ReadOptions::split_index`, `ReadOptions::stats` and `ReadOptions::progress` are ignored.
+     *
+     * The header is parsed upon construction, so an error is thrown here if it is invalid.
+     */
+    BatchReader(Reader& reader, size_t batch_size, const ReadOptions& options) :
+        batch_size(batch_size),
+        default_creator(internals::default_creator(options)),
+        parser(internals::configure_parser(choose_creator(options), options))
+    {
+        if (batch_size == 0) {
+            throw std::runtime_error("batch size should be positive");
+        }
+        parser.set_record_index();
+        parser.set_stats();
+        parser.set_progress(); // as 'options' may not outlive this object.
+
+        if (!options.parallel) {
+            input.reset(new byteme::SerialBufferedReader<char, Reader*>(&reader, options.buffer_size));
+        } else if (options.prefetch_depth <= 1) {
+            input.reset(new byteme::ParallelBufferedReader<char, Reader*>(&reader, options.buffer_size));
+        } else {
+            prefetch.reset(new PrefetchReader(&reader, options.buffer_size, options.prefetch_depth));
+            input.reset(new byteme::SerialBufferedReader<char, byteme::Reader*>(prefetch.get(), options.buffer_size));
+        }
+
+        Contents header;
+        remaining = parser.parse_header(*input, header);
+        my_names.swap(header.names);
+        types.resize(my_names.size(), UNKNOWN);
+
+        // Files without any fields are not reported in batches.
+        if (my_names.empty()) {
+            remaining = false;
+        } else if (remaining) {
+            next_line += Parser::skip_ahead(*input, options.skip_records);
+            remaining = input->valid();
+        }
+
+        records_left = options.max_records;
+        if (records_left == 0) {
+            remaining = false;
+        }
+    }
+
+    /**
+     * @cond
+     */
+    // Deleted as the parser refers to the creators inside this object.
+    BatchReader(const BatchReader&) = delete;
+    BatchReader& operator=(const BatchReader&) = delete;
+    /**
+     * @endcond
+     */
+
+public:
+    /**
+     * @return Names of the fields in the CSV file.
+     */
+    const std::vector<std::string>& names() const {
+        return my_names;
+    }
+
+    /**
+     * @param batch `Contents` to store the next batch of records.
+     * If this was filled by a previous call to `next()`, its fields will be cleared and reused where possible, see `Field::clear()`.
+     *
+     * @return Whether a batch was read.
+     * If `false`, there are no more records in the file and `batch` is not modified.
+     */
+    bool next(Contents& batch) {
+        if (!remaining) {
+            return false;
+        }
+        remaining = false; // in case of errors.
+
+        if (batch.names != my_names) {
+            batch.names = my_names;
+        }
+        batch.backing.reset();
+
+        size_t nfields = my_names.size();
+        batch.fields.resize(nfields);
+        for (size_t c = 0; c < nfields; ++c) {
+            auto& current = batch.fields[c];
+            if (current && current->type() == types[c] && current->clear()) {
+                continue;
+            }
+            if (types[c] == UNKNOWN) {
+                current.reset(new UnknownField);
+            } else {
+                current.reset(parser.create_field(batch, types[c], c, 0));
+            }
+        }
+
+        size_t line = next_line;
+        parser.parse_records(*input, batch, line, std::min(batch_size, records_left));
+        records_left -= line + 1 - next_line;
+        next_line = line + 1;
+        remaining = input->valid() && records_left > 0;
+
+        for (size_t c = 0; c < nfields; ++c) {
+            types[c] = batch.fields[c]->type();
+        }
+        return true;
+    }
+
+private:
+    const FieldCreator* choose_creator(const ReadOptions& options) const {
+        if (options.validate_only) {
+            return &validate_creator;
+        } else if (options.creator) {
+            return options.creator;
+        } else {
+            return &default_creator;
+        }
+    }
+
+    size_t batch_size;
+    DefaultFieldCreator<true> validate_creator;
+    DefaultFieldCreator<false> default_creator;
+    Parser parser;
+
+    // Declared before 'input' so that it is destroyed afterwards.
+    std::unique_ptr<PrefetchReader> prefetch;
+    std::unique_ptr<byteme::BufferedReader<char> > input;
+    std::vector<std::string> my_names;
+    std::vector<Type> types;
+    bool remaining = false;
+    size_t next_line = 1;
+    size_t records_left;
+};
+
+}
+
+#endif
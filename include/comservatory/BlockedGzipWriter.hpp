@@ -0,0 +1,229 @@
+#ifndef COMSERVATORY_BLOCKEDGZIPWRITER_HPP
+#define COMSERVATORY_BLOCKEDGZIPWRITER_HPP
+
+#if __has_include("zlib.h")
+
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+
+#include "zlib.h"
+
+#include "parallelize.hpp"
+
+/**
+ * @file BlockedGzipWriter.hpp
+ *
+ * @brief Defines the `BlockedGzipWriter` class for writing blocked Gzip files.
+ */
+
+namespace comservatory {
+
+/**
+ * @cond
+ */
+namespace internals {
+
+// Maximum uncompressed size of each block, chosen such that the compressed
+// block (even if stored without compression) fits in 64 KB.
+constexpr size_t bgzf_block_input = 65280;
+
+constexpr size_t bgzf_block_max = 65536;
+
+inline void write_le(unsigned char* ptr, uint32_t value, int nbytes) {
+    for (int i = 0; i < nbytes; ++i) {
+        ptr[i] = (value >> (8 * i)) & 0xff;
+    }
+}
+
+inline size_t deflate_raw(const unsigned char* input, size_t n, unsigned char* output, size_t capacity, int level) {
+    z_stream strm;
+    strm.zalloc = Z_NULL;
+    strm.zfree = Z_NULL;
+    strm.opaque = Z_NULL;
+    if (deflateInit2(&strm, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw std::runtime_error("failed to initialize Gzip compression");
+    }
+
+    strm.next_in = const_cast<unsigned char*>(input);
+    strm.avail_in = n;
+    strm.next_out = output;
+    strm.avail_out = capacity;
+    int ret = deflate(&strm, Z_FINISH);
+    size_t used = capacity - strm.avail_out;
+    deflateEnd(&strm);
+    return (ret == Z_STREAM_END ? used : 0);
+}
+
+// Compresses 'n' bytes into a single BGZF block in 'output'.
+inline void deflate_bgzf_block(const unsigned char* input, size_t n, std::vector<unsigned char>& output, int level) {
+    static constexpr unsigned char header[] = { 0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff, 6, 0, 'B', 'C', 2, 0 };
+    constexpr size_t header_size = sizeof(header) + 2, trailer_size = 8;
+
+    output.resize(bgzf_block_max);
+    size_t capacity = bgzf_block_max - header_size - trailer_size;
+    size_t used = deflate_raw(input, n, output.data() + header_size, capacity, level);
+    if (used == 0) {
+        // Falling back to storing the data, which is guaranteed to fit.
+        used = deflate_raw(input, n, output.data() + header_size, capacity, 0);
+        if (used == 0) {
+            throw std::runtime_error("failed to compress BGZF block");
+        }
+    }
+
+    std::copy(header, header + sizeof(header), output.begin());
+    size_t total = header_size + used + trailer_size;
+    write_le(output.data() + sizeof(header), total - 1, 2);
+
+    auto crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, input, n);
+    write_le(output.data() + header_size + used, crc, 4);
+    write_le(output.data() + header_size + used + 4, n, 4);
+    output.resize(total);
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @brief Write a blocked Gzip file.
+ *
+ * Data is compressed in independent blocks of up to 64 KB in the BGZF format, which is also used by `bgzip`.
+ * Each block is a valid Gzip member, so the output can be read by any Gzip decompressor;
+ * however, the blocks can also be decompressed in parallel with `ParallelGzipReader`.
+ * Compression is similarly parallelized across blocks.
+ *
+ * Only available if Zlib is available.
+ */
+class BlockedGzipWriter {
+public:
+    /**
+     * @param path Path to the output file.
+     * @param num_threads Number of threads to use for compression.
+     * @param level Compression level, from 0 to 9.
+     * @param blocks_per_thread Number of blocks to compress in each thread per batch.
+     */
+    BlockedGzipWriter(const char* path, int num_threads = 1, int level = Z_DEFAULT_COMPRESSION, size_t blocks_per_thread = 16) :
+        num_threads(std::max(num_threads, 1)),
+        level(level),
+        batch_size(std::max(blocks_per_thread, static_cast<size_t>(1)) * this->num_threads)
+    {
+        handle = std::fopen(path, "wb");
+        if (handle == NULL) {
+            throw std::runtime_error("failed to open file at '" + std::string(path) + "'");
+        }
+        pending.reserve(batch_size * internals::bgzf_block_input);
+    }
+
+    /**
+     * @param path Path to the output file.
+     * @param num_threads Number of threads to use for compression.
+     * @param level Compression level, from 0 to 9.
+     * @param blocks_per_thread Number of blocks to compress in each thread per batch.
+     */
+    BlockedGzipWriter(const std::string& path, int num_threads = 1, int level = Z_DEFAULT_COMPRESSION, size_t blocks_per_thread = 16) :
+        BlockedGzipWriter(path.c_str(), num_threads, level, blocks_per_thread) {}
+
+    /**
+     * Closes the file, see `finish()`.
+     * Errors are ignored here, so users should call `finish()` explicitly to check that the file was written successfully.
+     */
+    ~BlockedGzipWriter() {
+        if (handle) {
+            try {
+                finish();
+            } catch (...) {}
+        }
+    }
+
+    /**
+     * @cond
+     */
+    BlockedGzipWriter(const BlockedGzipWriter&) = delete;
+    BlockedGzipWriter& operator=(const BlockedGzipWriter&) = delete;
+    /**
+     * @endcond
+     */
+
+public:
+    /**
+     * @param data Pointer to an array of bytes.
+     * @param n Length of the array.
+     *
+     * Data is buffered until enough is available to fill a batch of blocks, after which the blocks are compressed and written.
+     */
+    void write(const char* data, size_t n) {
+        size_t capacity = batch_size * internals::bgzf_block_input;
+        while (n) {
+            size_t available = std::min(n, capacity - pending.size());
+            pending.insert(pending.end(), data, data + available);
+            data += available;
+            n -= available;
+            if (pending.size() == capacity) {
+                flush();
+            }
+        }
+    }
+
+    /**
+     * @param data String to write.
+     */
+    void write(const std::string& data) {
+        write(data.data(), data.size());
+    }
+
+    /**
+     * Compresses and writes any remaining data, adds the end-of-file marker and closes the file.
+     * No further calls to `write()` should be made.
+     */
+    void finish() {
+        flush();
+
+        // Adding an empty block as the end-of-file marker.
+        std::vector<unsigned char> eof;
+        internals::deflate_bgzf_block(NULL, 0, eof, level);
+        std::fwrite(eof.data(), 1, eof.size(), handle);
+
+        bool failed = std::ferror(handle);
+        failed = (std::fclose(handle) != 0) || failed;
+        handle = NULL;
+        if (failed) {
+            throw std::runtime_error("failed to write blocked Gzip file");
+        }
+    }
+
+private:
+    void flush() {
+        size_t nblocks = (pending.size() + internals::bgzf_block_input - 1) / internals::bgzf_block_input;
+        blocks.resize(std::max(blocks.size(), nblocks));
+        auto ptr = reinterpret_cast<const unsigned char*>(pending.data());
+        parallelize(nblocks, num_threads, [&](size_t b) -> void {
+            size_t start = b * internals::bgzf_block_input;
+            size_t length = std::min(internals::bgzf_block_input, pending.size() - start);
+            internals::deflate_bgzf_block(ptr + start, length, blocks[b], level);
+        });
+
+        for (size_t b = 0; b < nblocks; ++b) {
+            std::fwrite(blocks[b].data(), 1, blocks[b].size(), handle);
+        }
+        pending.clear();
+    }
+
+    std::FILE* handle;
+    int num_threads;
+    int level;
+    size_t batch_size;
+    std::vector<char> pending;
+    std::vector<std::vector<unsigned char> > blocks;
+};
+
+}
+
+#endif
+
+#endif
@@ -33,6 +33,39 @@ struct FieldCreator {
      */
     virtual Field* create(Type t, size_t n, bool dummy) const = 0;
 
+    /**
+     * @param current Pointer to an existing field of type `INTEGER`.
+     * @param t Type to promote to, currently always `NUMBER`.
+     *
+     * @return A new instance of a `Field` subclass of type `t`, containing the same values as `current` (including missing values).
+     * The contents of `current` may be moved into the output, as `current` is destroyed by the caller after this method returns.
+     *
+     * This is called when `ReadOptions::detect_integers = true` and a non-integer number is encountered in an `INTEGER` field.
+     * The default implementation handles the `FilledIntegerField`, `MaskedIntegerField` and `DummyIntegerField` classes;
+     * subclasses should override this method if `create()` returns other `IntegerField` subclasses.
+     */
+    virtual Field* promote(Field* current, Type t) const {
+        if (current->type() != INTEGER || t != NUMBER) {
+            throw std::runtime_error("cannot promote a field from " + type_to_name(current->type()) + " to " + type_to_name(t));
+        }
+
+        if (auto filled = dynamic_cast<FilledIntegerField*>(current)) {
+            auto output = new FilledNumberField;
+            output->missing.swap(filled->missing);
+            output->values.insert(output->values.end(), filled->values.begin(), filled->values.end());
+            return output;
+        } else if (auto masked = dynamic_cast<MaskedIntegerField*>(current)) {
+            auto output = new MaskedNumberField(masked->leading);
+            output->validity.swap(masked->validity);
+            output->values.insert(output->values.end(), masked->values.begin(), masked->values.end());
+            return output;
+        } else if (dynamic_cast<DummyIntegerField*>(current)) {
+            return new DummyNumberField(current->size());
+        }
+
+        throw std::runtime_error("no promotion defined for this INTEGER field");
+    }
+
     /**
      * @cond
      */
@@ -47,43 +80,46 @@ struct FieldCreator {
  */
 template<bool validate_only>
 struct DefaultFieldCreator : public FieldCreator {
-    Field* create(Type observed, size_t n, bool dummy) const {
-        Field* ptr;
+    DefaultFieldCreator(bool arena_strings = false, bool view_strings = false, bool masked = false) : 
+        arena_strings(arena_strings), view_strings(view_strings), masked(masked) {}
+
+    bool arena_strings;
+    bool view_strings;
+    bool masked;
+
+    template<typename T, Type tt>
+    Field* create_typed(size_t n, bool dummy) const {
+        if (dummy || validate_only) {
+            return new DummyField<T, tt>(n);
+        } else if (masked) {
+            return new MaskedField<T, tt>(n);
+        } else {
+            return new FilledField<T, tt>(n);
+        }
+    }
 
+    Field* create(Type observed, size_t n, bool dummy) const {
         switch (observed) {
             case STRING:
-                if (dummy || validate_only) {
-                    ptr = new DummyStringField(n);
-                } else {
-                    ptr = new FilledStringField(n);
+                if (!dummy && !validate_only) {
+                    if (view_strings) {
+                        return new StringViewField(n);
+                    } else if (arena_strings) {
+                        return new ArenaStringField(n);
+                    }
                 }
-                break;
+                return create_typed<std::string, STRING>(n, dummy);
             case NUMBER:
-                if (dummy || validate_only) {
-                    ptr = new DummyNumberField(n);
-                } else {
-                    ptr = new FilledNumberField(n);
-                }
-                break;
+                return create_typed<double, NUMBER>(n, dummy);
             case BOOLEAN:
-                if (dummy || validate_only) {
-                    ptr = new DummyBooleanField(n);
-                } else {
-                    ptr = new FilledBooleanField(n);
-                }
-                break;
+                return create_typed<bool, BOOLEAN>(n, dummy);
             case COMPLEX:
-                if (dummy || validate_only) {
-                    ptr = new DummyComplexField(n);
-                } else {
-                    ptr = new FilledComplexField(n);
-                }
-                break;
+                return create_typed<std::complex<double>, COMPLEX>(n, dummy);
+            case INTEGER:
+                return create_typed<int64_t, INTEGER>(n, dummy);
             default:
                 throw std::runtime_error("unrecognized type during field creation");
         }
-
-        return ptr;
     }
 };
 /**
@@ -2,9 +2,13 @@
 #define COMSERVATORY_FIELD_HPP
 
 #include <vector>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <complex>
 #include <numeric>
+#include <memory>
+#include <algorithm>
 #include "Type.hpp"
 
 /**
@@ -44,6 +48,18 @@ struct Field {
      */
     virtual void add_missing() = 0;
 
+    /**
+     * Append multiple missing values onto the field's vector of values.
+     * The default implementation calls `add_missing()` repeatedly; subclasses may override this with a more efficient implementation.
+     *
+     * @param n Number of missing values to append.
+     */
+    virtual void add_missing_many(size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            add_missing();
+        }
+    }
+
     /**
      * @return Boolean indicating whether this object contains loaded data.
      * This may be `false` if it is just a dummy for validation/placeholder purposes.
@@ -51,6 +67,18 @@ struct Field {
     virtual bool filled() const { 
         return true;
     }
+
+    /**
+     * Remove all values from the field, so that it can be reused for another batch of records, e.g., in `BatchReader`.
+     * Subclasses should retain any allocated memory where possible.
+     * The default implementation does nothing.
+     *
+     * @return Whether the field was cleared.
+     * If `false`, the caller should replace this field with a new instance.
+     */
+    virtual bool clear() {
+        return false;
+    }
 };
 
 /**
@@ -81,6 +109,15 @@ struct UnknownField : Field{
         ++nrecords;
         return;
     }
+
+    void add_missing_many(size_t n) {
+        nrecords += n;
+    }
+
+    bool clear() {
+        nrecords = 0;
+        return true;
+    }
 };
 
 /**
@@ -96,6 +133,78 @@ struct TypedField : public Field {
      * @param x Value to be appended to the `TypedField`'s vector of values.
      */
     virtual void push_back(T x) = 0;
+
+    /**
+     * The default implementation calls `push_back()` repeatedly; subclasses may override this with a more efficient implementation.
+     *
+     * @param x Pointer to an array of values to be appended to the `TypedField`'s vector of values.
+     * @param n Length of the array.
+     */
+    virtual void push_back_many(const T* x, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            push_back(x[i]);
+        }
+    }
+};
+
+/**
+ * @brief Specialization of `TypedField` for strings.
+ *
+ * Subclasses may optionally accept the contents of each string directly from the parser,
+ * avoiding the construction of a temporary `std::string` for each value.
+ */
+template<>
+struct TypedField<std::string, STRING> : public Field {
+    Type type() const { return STRING; }
+
+    /**
+     * @param x Value to be appended to the `TypedField`'s vector of values.
+     */
+    virtual void push_back(std::string x) = 0;
+
+    /**
+     * The default implementation calls `push_back()` repeatedly; subclasses may override this with a more efficient implementation.
+     *
+     * @param x Pointer to an array of values to be appended to the `TypedField`'s vector of values.
+     * @param n Length of the array.
+     */
+    virtual void push_back_many(const std::string* x, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            push_back(x[i]);
+        }
+    }
+
+    /**
+     * @return Pointer to a buffer onto which the parser should directly append the characters of the next string.
+     * Once the string is complete, the parser will call `finish_append()`.
+     * If `NULL`, the parser will instead call `push_back()`.
+     */
+    virtual std::vector<char>* start_append() {
+        return NULL;
+    }
+
+    /**
+     * Indicate that the current string has been appended to the buffer returned by `start_append()`.
+     */
+    virtual void finish_append() {}
+
+    /**
+     * @return Whether this field prefers to receive strings as views via `push_back_view()`.
+     * This is only respected when parsing contiguous in-memory inputs.
+     */
+    virtual bool use_views() const {
+        return false;
+    }
+
+    /**
+     * @param x View of the string to be appended.
+     * @param persistent Whether `x` refers to the input buffer and remains valid for as long as the input is kept alive, see `Contents::backing`.
+     * If `false`, `x` is only valid during this call and its contents should be copied.
+     */
+    virtual void push_back_view(std::string_view x, bool persistent) {
+        (void)persistent;
+        push_back(std::string(x));
+    }
 };
 
 /**
@@ -139,6 +248,23 @@ struct FilledField : public TypedField<T, tt> {
         values.resize(i + 1);
         return;
     }
+
+    void push_back_many(const T* x, size_t n) {
+        values.insert(values.end(), x, x + n);
+    }
+
+    void add_missing_many(size_t n) {
+        size_t i = values.size();
+        missing.resize(missing.size() + n);
+        std::iota(missing.end() - n, missing.end(), i);
+        values.resize(i + n);
+    }
+
+    bool clear() {
+        missing.clear();
+        values.clear();
+        return true;
+    }
 };
 
 /**
@@ -176,9 +302,141 @@ struct DummyField : public TypedField<T, tt> {
         return;
     }
 
+    void push_back_many(const T*, size_t n) {
+        nrecords += n;
+    }
+
+    void add_missing_many(size_t n) {
+        nrecords += n;
+    }
+
     bool filled() const { 
         return false;
     }
+
+    bool clear() {
+        nrecords = 0;
+        return true;
+    }
+};
+
+/**
+ * @brief Template class for a typed field that uses a validity bitmap to record missing values.
+ * @tparam T Data type used to store the values.
+ * @tparam tt The `Type` to be returned by `type()`.
+ *
+ * Compared to `FilledField`, this uses 1 bit instead of 8 bytes per missing value.
+ * Leading missing values are run-length encoded, so that converting a field from an `UnknownField` with many missing values is a constant-time operation.
+ * Specifically, the first `leading` values are missing and are not stored in `values` or `validity`;
+ * the remaining values are stored in `values`, where the `i`-th entry is missing if the `i`-th bit of `validity` is unset.
+ */
+template<typename T, Type tt>
+struct MaskedField : public TypedField<T, tt> {
+    /**
+     * @param n Number of missing values at the start of the field.
+     * This may be non-zero if converting a field from an `UnknownField`.
+     */
+    MaskedField(size_t n = 0) : leading(n) {}
+
+    /**
+     * Number of leading missing values.
+     */
+    size_t leading;
+
+    /**
+     * Values after the leading missing values.
+     * Missing entries are default-constructed.
+     */
+    std::vector<T> values;
+
+    /**
+     * Validity bitmap for `values`, where the `i`-th entry is present if bit `i % 64` of `validity[i / 64]` is set.
+     */
+    std::vector<uint64_t> validity;
+
+    size_t size() const { 
+        return leading + values.size(); 
+    }
+
+    void push_back(T x) {
+        size_t i = values.size();
+        if (i % 64 == 0) {
+            validity.push_back(0);
+        }
+        validity.back() |= static_cast<uint64_t>(1) << (i % 64);
+        values.emplace_back(std::move(x));
+    }
+
+    void add_missing() {
+        if (values.empty()) {
+            ++leading;
+            return;
+        }
+
+        size_t i = values.size();
+        if (i % 64 == 0) {
+            validity.push_back(0);
+        }
+        values.emplace_back();
+    }
+
+    void add_missing_many(size_t n) {
+        if (values.empty()) {
+            leading += n;
+            return;
+        }
+
+        // Unset bits are already zero in the existing words.
+        size_t total = values.size() + n;
+        values.resize(total);
+        validity.resize((total + 63) / 64);
+    }
+
+    bool clear() {
+        leading = 0;
+        values.clear();
+        validity.clear();
+        return true;
+    }
+
+    /**
+     * @param i Index of the record.
+     * @return Whether the `i`-th value is missing.
+     */
+    bool is_missing(size_t i) const {
+        if (i < leading) {
+            return true;
+        }
+        i -= leading;
+        return !(validity[i / 64] & (static_cast<uint64_t>(1) << (i % 64)));
+    }
+
+    /**
+     * @param i Index of the record.
+     * @return The `i`-th value, or a default-constructed value if it is missing.
+     */
+    T get(size_t i) const {
+        if (i < leading) {
+            return T();
+        }
+        return values[i - leading];
+    }
+
+    /**
+     * @param other Another field, whose values are to be appended onto the end of this field.
+     */
+    void append(const MaskedField<T, tt>& other) {
+        for (size_t i = 0; i < other.leading; ++i) {
+            add_missing();
+        }
+        for (size_t i = 0, n = other.values.size(); i < n; ++i) {
+            if (other.validity[i / 64] & (static_cast<uint64_t>(1) << (i % 64))) {
+                push_back(other.values[i]);
+            } else {
+                add_missing();
+            }
+        }
+    }
 };
 
 /** Various realizations. **/
@@ -198,6 +456,213 @@ typedef FilledField<std::string, STRING> FilledStringField;
  */
 typedef DummyField<std::string, STRING> DummyStringField;
 
+/**
+ * String `Field` with a validity bitmap for missing values.
+ */
+typedef MaskedField<std::string, STRING> MaskedStringField;
+
+/**
+ * @brief String `Field` with all values stored in a single contiguous buffer.
+ *
+ * The characters of all strings are concatenated in `bytes`, where the `i`-th string spans `[offsets[i], offsets[i + 1])`.
+ * This avoids the allocation and per-value overhead of a `std::vector<std::string>`, at the cost of only providing read-only access via `get()`.
+ * Missing values are stored as empty strings.
+ */
+struct ArenaStringField : public StringField {
+    /**
+     * @param n Number of missing values with which to fill the field.
+     * This may be non-zero if converting a field from an `UnknownField`.
+     */
+    ArenaStringField(size_t n = 0) : missing(n), offsets(n + 1) {
+        if (n) {
+            std::iota(missing.begin(), missing.end(), 0);
+        }
+    }
+
+    /**
+     * Indices of the missing values.
+     */
+    std::vector<size_t> missing;
+
+    /**
+     * Concatenated characters of all strings.
+     */
+    std::vector<char> bytes;
+
+    /**
+     * Offsets into `bytes` for the start of each string, plus the end of the last string.
+     * This is always of length equal to `size() + 1`.
+     */
+    std::vector<uint64_t> offsets;
+
+    size_t size() const { 
+        return offsets.size() - 1; 
+    }
+
+    void push_back(std::string x) {
+        bytes.insert(bytes.end(), x.begin(), x.end());
+        offsets.push_back(bytes.size());
+    }
+
+    void add_missing() {
+        missing.push_back(size());
+        offsets.push_back(bytes.size());
+    }
+
+    void add_missing_many(size_t n) {
+        size_t i = size();
+        missing.resize(missing.size() + n);
+        std::iota(missing.end() - n, missing.end(), i);
+        offsets.resize(offsets.size() + n, bytes.size());
+    }
+
+    bool clear() {
+        missing.clear();
+        bytes.clear();
+        offsets.resize(1);
+        return true;
+    }
+
+    std::vector<char>* start_append() {
+        return &bytes;
+    }
+
+    void finish_append() {
+        offsets.push_back(bytes.size());
+    }
+
+    /**
+     * @param i Index of the value.
+     * @return View of the `i`-th string, valid until the next modification of the field.
+     */
+    std::string_view get(size_t i) const {
+        return std::string_view(bytes.data() + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+
+    /**
+     * @param other Another field, whose values are to be appended onto the end of this field.
+     */
+    void append(const ArenaStringField& other) {
+        size_t nold = size();
+        for (auto m : other.missing) {
+            missing.push_back(m + nold);
+        }
+
+        uint64_t shift = bytes.size();
+        bytes.insert(bytes.end(), other.bytes.begin(), other.bytes.end());
+        for (size_t i = 1, end = other.offsets.size(); i < end; ++i) {
+            offsets.push_back(other.offsets[i] + shift);
+        }
+    }
+};
+
+/**
+ * @brief String `Field` that stores views into the input buffer.
+ *
+ * When parsing contiguous in-memory inputs, strings without escaped quotes are stored as views into the input buffer, without any copying.
+ * Other strings (i.e., with escapes, or from streaming inputs) are copied into a side arena owned by this field.
+ * The input buffer must outlive this field; this is guaranteed for buffers owned by `Contents::backing`.
+ */
+struct StringViewField : public StringField {
+    /**
+     * @param n Number of missing values with which to fill the field.
+     * This may be non-zero if converting a field from an `UnknownField`.
+     */
+    StringViewField(size_t n = 0) : missing(n), values(n) {
+        if (n) {
+            std::iota(missing.begin(), missing.end(), 0);
+        }
+    }
+
+    /**
+     * Indices of the missing values.
+     */
+    std::vector<size_t> missing;
+
+    /**
+     * Views of all strings, where missing values are represented by empty views.
+     */
+    std::vector<std::string_view> values;
+
+    size_t size() const { 
+        return values.size(); 
+    }
+
+    void push_back(std::string x) {
+        values.push_back(store(x));
+    }
+
+    void add_missing() {
+        missing.push_back(values.size());
+        values.emplace_back();
+    }
+
+    void add_missing_many(size_t n) {
+        size_t i = values.size();
+        missing.resize(missing.size() + n);
+        std::iota(missing.end() - n, missing.end(), i);
+        values.resize(i + n);
+    }
+
+    bool use_views() const {
+        return true;
+    }
+
+    void push_back_view(std::string_view x, bool persistent) {
+        values.push_back(persistent ? x : store(x));
+    }
+
+    /**
+     * @param other Another field, whose values are to be appended onto the end of this field.
+     * The side arena of `other` is transferred to this field, so `other` should not be used afterwards.
+     */
+    void append(StringViewField& other) {
+        size_t nold = values.size();
+        for (auto m : other.missing) {
+            missing.push_back(m + nold);
+        }
+        values.insert(values.end(), other.values.begin(), other.values.end());
+
+        for (auto& b : other.blocks) {
+            blocks.push_back(std::move(b));
+        }
+        other.blocks.clear();
+        other.current = NULL;
+        other.used = block_size;
+    }
+
+private:
+    static constexpr size_t block_size = 4096;
+    std::vector<std::unique_ptr<char[]> > blocks;
+    char* current = NULL;
+    size_t used = block_size;
+
+    // Blocks are never reallocated, so views into them remain valid.
+    std::string_view store(std::string_view x) {
+        size_t n = x.size();
+        if (n == 0) {
+            return std::string_view();
+        }
+
+        if (n > block_size - used) {
+            if (n > block_size / 2) {
+                // Large strings get their own block, so that we don't waste the rest of the current block.
+                blocks.emplace_back(new char[n]);
+                std::copy(x.begin(), x.end(), blocks.back().get());
+                return std::string_view(blocks.back().get(), n);
+            }
+            blocks.emplace_back(new char[block_size]);
+            current = blocks.back().get();
+            used = 0;
+        }
+
+        char* dest = current + used;
+        std::copy(x.begin(), x.end(), dest);
+        used += n;
+        return std::string_view(dest, n);
+    }
+};
+
 /**
  * Virtual class for a `Field` of double-precision numbers.
  */
@@ -213,6 +678,32 @@ typedef FilledField<double, NUMBER> FilledNumberField;
  */
 typedef DummyField<double, NUMBER> DummyNumberField;
 
+/**
+ * Numeric `Field` with a validity bitmap for missing values.
+ */
+typedef MaskedField<double, NUMBER> MaskedNumberField;
+
+/**
+ * Virtual class for a `Field` of 64-bit integers.
+ * This is only used when `ReadOptions::detect_integers = true`.
+ */
+typedef TypedField<int64_t, INTEGER> IntegerField;
+
+/**
+ * Integer `Field` with a backing `std::vector<int64_t>`.
+ */
+typedef FilledField<int64_t, INTEGER> FilledIntegerField;
+
+/**
+ * Dummy integer `Field`.
+ */
+typedef DummyField<int64_t, INTEGER> DummyIntegerField;
+
+/**
+ * Integer `Field` with a validity bitmap for missing values.
+ */
+typedef MaskedField<int64_t, INTEGER> MaskedIntegerField;
+
 /**
  * @brief Virtual class for a `Field` of booleans.
  */
@@ -228,6 +719,11 @@ typedef FilledField<bool, BOOLEAN> FilledBooleanField;
  */
 typedef DummyField<bool, BOOLEAN> DummyBooleanField;
 
+/**
+ * Boolean `Field` with a validity bitmap for missing values.
+ */
+typedef MaskedField<bool, BOOLEAN> MaskedBooleanField;
+
 /**
  * Virtual class for a `Field` of complex numbers.
  */
@@ -243,6 +739,11 @@ typedef FilledField<std::complex<double>, COMPLEX> FilledComplexField;
  */
 typedef DummyField<std::complex<double>, COMPLEX> DummyComplexField;
 
+/**
+ * Complex `Field` with a validity bitmap for missing values.
+ */
+typedef MaskedField<std::complex<double>, COMPLEX> MaskedComplexField;
+
 }
 
 #endif
@@ -0,0 +1,561 @@
+#ifndef COMSERVATORY_GZIPINDEX_HPP
+#define COMSERVATORY_GZIPINDEX_HPP
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <algorithm>
+
+#include "RecordIndex.hpp"
+#include "parallelize.hpp"
+
+#if __has_include("zlib.h")
+#include "zlib.h"
+#include "byteme/Reader.hpp"
+#endif
+
+/**
+ * @file GzipIndex.hpp
+ *
+ * @brief Defines the `GzipIndex` class for random access into Gzipped files.
+ */
+
+namespace comservatory {
+
+/**
+ * @brief Access point in a Gzipped file.
+ *
+ * Decompression can be resumed from an access point by priming the inflater with the leftover bits and the window of preceding output.
+ */
+struct GzipCheckpoint {
+    /**
+     * Offset in the compressed file of the first byte after the access point.
+     */
+    uint64_t compressed = 0;
+
+    /**
+     * Number of bits (0 to 7) of the byte before `compressed` that belong to the data after the access point.
+     */
+    int bits = 0;
+
+    /**
+     * Offset in the decompressed stream corresponding to the access point.
+     */
+    uint64_t uncompressed = 0;
+
+    /**
+     * Up to 32 KB of the decompressed stream immediately preceding `uncompressed`.
+     * This is used as the dictionary for back-references after the access point.
+     */
+    std::vector<unsigned char> window;
+};
+
+/**
+ * @brief Index of access points in a Gzipped file.
+ *
+ * Gzip decompression is inherently sequential, so reading from an arbitrary position requires decompressing everything before it.
+ * This index stores access points at intervals of the decompressed stream, allowing decompression to be resumed from the closest preceding access point.
+ * Multi-member files (e.g., from concatenating Gzipped files) are supported.
+ * The index is typically created by `build_gzip_index()` and can be used with `ReadOptions::gzip_index` or `read_rows()`.
+ */
+struct GzipIndex {
+    /**
+     * @param span Minimum distance between access points in the decompressed stream.
+     */
+    GzipIndex(uint64_t span = 4194304) : span(span) {}
+
+    /**
+     * Minimum distance between access points in the decompressed stream.
+     */
+    uint64_t span;
+
+    /**
+     * Access points in the file, sorted by increasing offset.
+     * The first access point always lies at the start of the decompressed stream.
+     */
+    std::vector<GzipCheckpoint> checkpoints;
+
+    /**
+     * Size of the compressed file in bytes.
+     */
+    uint64_t compressed_size = 0;
+
+    /**
+     * Size of the decompressed stream in bytes.
+     */
+    uint64_t size = 0;
+
+    /**
+     * @param offset Offset in the decompressed stream.
+     * @return Index of the closest access point that precedes (or is equal to) `offset`.
+     */
+    size_t locate(uint64_t offset) const {
+        if (checkpoints.empty()) {
+            throw std::runtime_error("Gzip index does not contain any access points");
+        }
+        auto it = std::upper_bound(checkpoints.begin(), checkpoints.end(), offset, [](uint64_t left, const GzipCheckpoint& right) -> bool {
+            return left < right.uncompressed;
+        });
+        return (it == checkpoints.begin() ? 0 : (it - checkpoints.begin()) - 1);
+    }
+};
+
+/**
+ * @cond
+ */
+namespace internals {
+
+inline const char* gzip_index_magic() {
+    return "CSVGZIX1";
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @param index Index of a Gzipped file.
+ * @param path Path to the sidecar file in which to save the index.
+ *
+ * The index is saved in a binary format with little-endian 64-bit integers, which can be loaded with `load_gzip_index()`.
+ */
+inline void save_gzip_index(const GzipIndex& index, const char* path) {
+    std::FILE* handle = std::fopen(path, "wb");
+    if (handle == NULL) {
+        throw std::runtime_error("failed to open Gzip index at '" + std::string(path) + "'");
+    }
+
+    std::fwrite(internals::gzip_index_magic(), 1, 8, handle);
+    internals::write_uint64(handle, index.span);
+    internals::write_uint64(handle, index.compressed_size);
+    internals::write_uint64(handle, index.size);
+    internals::write_uint64(handle, index.checkpoints.size());
+    for (const auto& point : index.checkpoints) {
+        internals::write_uint64(handle, point.compressed);
+        internals::write_uint64(handle, point.bits);
+        internals::write_uint64(handle, point.uncompressed);
+        internals::write_uint64(handle, point.window.size());
+        std::fwrite(point.window.data(), 1, point.window.size(), handle);
+    }
+
+    bool failed = std::ferror(handle);
+    if (std::fclose(handle) != 0 || failed) {
+        throw std::runtime_error("failed to write Gzip index at '" + std::string(path) + "'");
+    }
+}
+
+/**
+ * @param index Index of a Gzipped file.
+ * @param path Path to the sidecar file in which to save the index.
+ */
+inline void save_gzip_index(const GzipIndex& index, const std::string& path) {
+    save_gzip_index(index, path.c_str());
+}
+
+/**
+ * @param path Path to a sidecar file created by `save_gzip_index()`.
+ * @return The index of the Gzipped file.
+ */
+inline GzipIndex load_gzip_index(const char* path) {
+    std::FILE* handle = std::fopen(path, "rb");
+    if (handle == NULL) {
+        throw std::runtime_error("failed to open Gzip index at '" + std::string(path) + "'");
+    }
+
+    char magic[8];
+    if (std::fread(magic, 1, 8, handle) != 8 || std::string(magic, 8) != internals::gzip_index_magic()) {
+        std::fclose(handle);
+        throw std::runtime_error("unrecognized Gzip index format at '" + std::string(path) + "'");
+    }
+
+    GzipIndex output(internals::read_uint64(handle, path));
+    output.compressed_size = internals::read_uint64(handle, path);
+    output.size = internals::read_uint64(handle, path);
+    uint64_t n = internals::read_uint64(handle, path);
+    if (n > output.compressed_size + 1) {
+        std::fclose(handle);
+        throw std::runtime_error("invalid Gzip index at '" + std::string(path) + "'");
+    }
+
+    output.checkpoints.resize(n);
+    for (auto& point : output.checkpoints) {
+        point.compressed = internals::read_uint64(handle, path);
+        point.bits = internals::read_uint64(handle, path);
+        point.uncompressed = internals::read_uint64(handle, path);
+        uint64_t nwindow = internals::read_uint64(handle, path);
+        if (point.bits > 7 || nwindow > 32768) {
+            std::fclose(handle);
+            throw std::runtime_error("invalid Gzip index at '" + std::string(path) + "'");
+        }
+        point.window.resize(nwindow);
+        if (std::fread(point.window.data(), 1, nwindow, handle) != nwindow) {
+            std::fclose(handle);
+            throw std::runtime_error("truncated Gzip index at '" + std::string(path) + "'");
+        }
+    }
+
+    std::fclose(handle);
+    return output;
+}
+
+/**
+ * @param path Path to a sidecar file created by `save_gzip_index()`.
+ * @return The index of the Gzipped file.
+ */
+inline GzipIndex load_gzip_index(const std::string& path) {
+    return load_gzip_index(path.c_str());
+}
+
+#if __has_include("zlib.h")
+
+/**
+ * @cond
+ */
+namespace internals {
+
+constexpr size_t gzip_window_size = 32768;
+
+constexpr size_t gzip_chunk_size = 65536;
+
+inline uint64_t file_size(std::FILE* handle) {
+    if (std::fseek(handle, 0, SEEK_END) != 0) {
+        throw std::runtime_error("failed to seek to the end of the file");
+    }
+    auto size = std::ftell(handle);
+    if (size < 0 || std::fseek(handle, 0, SEEK_SET) != 0) {
+        throw std::runtime_error("failed to seek to the start of the file");
+    }
+    return size;
+}
+
+inline void check_inflate(int ret) {
+    if (ret == Z_NEED_DICT || ret == Z_DATA_ERROR) {
+        throw std::runtime_error("invalid Gzip-compressed data");
+    } else if (ret == Z_MEM_ERROR) {
+        throw std::runtime_error("insufficient memory for Gzip decompression");
+    } else if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+        throw std::runtime_error("failed to decompress Gzip-compressed data");
+    }
+}
+
+// RAII wrappers, so that we don't leak on errors.
+struct GzipFileHandle {
+    GzipFileHandle(const char* path) : handle(std::fopen(path, "rb")) {
+        if (handle == NULL) {
+            throw std::runtime_error("failed to open file at '" + std::string(path) + "'");
+        }
+    }
+
+    ~GzipFileHandle() {
+        std::fclose(handle);
+    }
+
+    GzipFileHandle(const GzipFileHandle&) = delete;
+    GzipFileHandle& operator=(const GzipFileHandle&) = delete;
+
+    std::FILE* handle;
+};
+
+struct GzipStream {
+    GzipStream(int window_bits) {
+        stream.zalloc = Z_NULL;
+        stream.zfree = Z_NULL;
+        stream.opaque = Z_NULL;
+        stream.avail_in = 0;
+        stream.next_in = Z_NULL;
+        if (inflateInit2(&stream, window_bits) != Z_OK) {
+            throw std::runtime_error("failed to initialize Gzip decompression");
+        }
+    }
+
+    ~GzipStream() {
+        inflateEnd(&stream);
+    }
+
+    GzipStream(const GzipStream&) = delete;
+    GzipStream& operator=(const GzipStream&) = delete;
+
+    z_stream stream;
+};
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @param path Path to a Gzipped file.
+ * @param span Minimum distance between access points in the decompressed stream.
+ * Smaller values allow faster random access at the cost of a larger index, as each access point stores up to 32 KB.
+ *
+ * @return Index of access points in the file.
+ *
+ * This decompresses the entire file once, adding an access point at the first deflate block boundary after every `span` bytes of decompressed data.
+ * Only available if Zlib is available.
+ */
+inline GzipIndex build_gzip_index(const char* path, uint64_t span = 4194304) {
+    GzipIndex output(span);
+    internals::GzipFileHandle file(path);
+    output.compressed_size = internals::file_size(file.handle);
+
+    internals::GzipStream gz(47); // i.e., automatic detection of the Gzip or Zlib header.
+    auto& strm = gz.stream;
+    std::vector<unsigned char> input(internals::gzip_chunk_size);
+    std::vector<unsigned char> window(internals::gzip_window_size);
+
+    uint64_t totin = 0, totout = 0;
+    bool finished = false;
+    strm.avail_out = 0;
+
+    while (!finished) {
+        if (strm.avail_in == 0) {
+            strm.avail_in = std::fread(input.data(), 1, input.size(), file.handle);
+            if (std::ferror(file.handle)) {
+                throw std::runtime_error("failed to read Gzip file at '" + std::string(path) + "'");
+            }
+            if (strm.avail_in == 0) {
+                throw std::runtime_error("Gzip file at '" + std::string(path) + "' is truncated");
+            }
+            strm.next_in = input.data();
+        }
+
+        do {
+            // The window is used as a circular buffer for the output.
+            if (strm.avail_out == 0) {
+                strm.avail_out = window.size();
+                strm.next_out = window.data();
+            }
+
+            totin += strm.avail_in;
+            totout += strm.avail_out;
+            int ret = inflate(&strm, Z_BLOCK);
+            totin -= strm.avail_in;
+            totout -= strm.avail_out;
+            internals::check_inflate(ret);
+
+            if (ret == Z_STREAM_END) {
+                // Checking if there's another member in this file.
+                if (strm.avail_in == 0) {
+                    strm.avail_in = std::fread(input.data(), 1, input.size(), file.handle);
+                    strm.next_in = input.data();
+                }
+                if (strm.avail_in == 0) {
+                    finished = true;
+                    break;
+                }
+                inflateReset(&strm);
+                continue;
+            }
+
+            // At the end of a block that isn't the last, all output from the
+            // block has been delivered and only up to 7 bits of the next
+            // block have been consumed. The first check gives us an access
+            // point just after the header.
+            if ((strm.data_type & 128) && !(strm.data_type & 64) && (output.checkpoints.empty() || totout - output.checkpoints.back().uncompressed >= span)) {
+                output.checkpoints.emplace_back();
+                auto& point = output.checkpoints.back();
+                point.compressed = totin;
+                point.bits = strm.data_type & 7;
+                point.uncompressed = totout;
+
+                // Unrolling the circular buffer so that the window is in order.
+                auto& w = point.window;
+                size_t left = strm.avail_out;
+                w.resize(window.size());
+                std::copy(window.end() - left, window.end(), w.begin());
+                std::copy(window.begin(), window.end() - left, w.begin() + left);
+                if (totout < w.size()) {
+                    w.erase(w.begin(), w.end() - totout);
+                }
+            }
+        } while (strm.avail_in != 0);
+    }
+
+    output.size = totout;
+    return output;
+}
+
+/**
+ * @param path Path to a Gzipped file.
+ * @param span Minimum distance between access points in the decompressed stream.
+ *
+ * @return Index of access points in the file.
+ */
+inline GzipIndex build_gzip_index(const std::string& path, uint64_t span = 4194304) {
+    return build_gzip_index(path.c_str(), span);
+}
+
+/**
+ * @brief Read a Gzipped file from an arbitrary position.
+ *
+ * This resumes decompression from the closest access point in a `GzipIndex`,
+ * so only the data between the access point and the requested position needs to be decompressed and discarded.
+ * Only available if Zlib is available.
+ */
+class GzipIndexedReader : public byteme::Reader {
+public:
+    /**
+     * @param path Path to a Gzipped file.
+     * @param index Index of access points in the file at `path`, typically created by `build_gzip_index()`.
+     * This should outlive the reader.
+     * @param offset Position in the decompressed stream at which to start reading.
+     * This should be no greater than `GzipIndex::size`.
+     */
+    GzipIndexedReader(const char* path, const GzipIndex& index, uint64_t offset) : file(path), gz(-15), input(internals::gzip_chunk_size) {
+        if (internals::file_size(file.handle) != index.compressed_size) {
+            throw std::runtime_error("Gzip index does not match the size of the file");
+        }
+        if (offset > index.size) {
+            throw std::runtime_error("requested offset is beyond the end of the decompressed stream");
+        }
+
+        // Starting in raw mode from the access point, see zran.c in the Zlib distribution.
+        const auto& point = index.checkpoints[index.locate(offset)];
+        auto& strm = gz.stream;
+        if (std::fseek(file.handle, point.compressed - (point.bits ? 1 : 0), SEEK_SET) != 0) {
+            throw std::runtime_error("failed to seek to the access point in the Gzip file");
+        }
+        if (point.bits) {
+            int current = std::fgetc(file.handle);
+            if (current == EOF) {
+                throw std::runtime_error("Gzip index does not match the contents of the file");
+            }
+            inflatePrime(&strm, point.bits, current >> (8 - point.bits));
+        }
+        if (!point.window.empty()) {
+            inflateSetDictionary(&strm, point.window.data(), point.window.size());
+        }
+
+        std::vector<unsigned char> discard(internals::gzip_chunk_size);
+        uint64_t remaining = offset - point.uncompressed;
+        while (remaining) {
+            size_t got = read(discard.data(), std::min(remaining, static_cast<uint64_t>(discard.size())));
+            if (got == 0) {
+                throw std::runtime_error("Gzip index does not match the contents of the file");
+            }
+            remaining -= got;
+        }
+    }
+
+    /**
+     * @param path Path to a Gzipped file.
+     * @param index Index of access points in the file at `path`.
+     * @param offset Position in the decompressed stream at which to start reading.
+     */
+    GzipIndexedReader(const std::string& path, const GzipIndex& index, uint64_t offset) : GzipIndexedReader(path.c_str(), index, offset) {}
+
+    /**
+     * @cond
+     */
+    GzipIndexedReader(const GzipIndexedReader&) = delete;
+    GzipIndexedReader& operator=(const GzipIndexedReader&) = delete;
+    /**
+     * @endcond
+     */
+
+public:
+    /**
+     * @param buffer Pointer to an array of length `n`, to store the decompressed bytes.
+     * @param n Maximum number of bytes to read.
+     * @return Number of bytes read into `buffer`, which is only less than `n` at the end of the stream.
+     */
+    size_t read(unsigned char* buffer, size_t n) {
+        auto& strm = gz.stream;
+        strm.next_out = buffer;
+        strm.avail_out = n;
+
+        while (strm.avail_out && !finished) {
+            if (strm.avail_in == 0 && !refill()) {
+                throw std::runtime_error("Gzip file is truncated");
+            }
+
+            int ret = inflate(&strm, Z_NO_FLUSH);
+            internals::check_inflate(ret);
+            if (ret != Z_STREAM_END) {
+                continue;
+            }
+
+            // Raw mode doesn't consume the trailer of the current member.
+            if (raw) {
+                for (int i = 0; i < 8; ++i) {
+                    if (strm.avail_in == 0 && !refill()) {
+                        throw std::runtime_error("Gzip file is truncated");
+                    }
+                    ++strm.next_in;
+                    --strm.avail_in;
+                }
+            }
+
+            // Checking if there's another member in this file.
+            if (strm.avail_in == 0 && !refill()) {
+                finished = true;
+            } else if (raw) {
+                inflateReset2(&strm, 31);
+                raw = false;
+            } else {
+                inflateReset(&strm);
+            }
+        }
+
+        return n - strm.avail_out;
+    }
+
+private:
+    bool refill() {
+        auto& strm = gz.stream;
+        strm.avail_in = std::fread(input.data(), 1, input.size(), file.handle);
+        if (std::ferror(file.handle)) {
+            throw std::runtime_error("failed to read Gzip file");
+        }
+        strm.next_in = input.data();
+        return strm.avail_in > 0;
+    }
+
+    internals::GzipFileHandle file;
+    internals::GzipStream gz;
+    std::vector<unsigned char> input;
+    bool raw = true;
+    bool finished = false;
+};
+
+/**
+ * @cond
+ */
+namespace internals {
+
+// Decompresses the entire file by resuming from each access point in
+// parallel, writing directly into the final buffer.
+inline std::vector<char> inflate_all(const char* path, const GzipIndex& index, int nthreads) {
+    std::vector<char> buffer(index.size);
+    size_t npoints = index.checkpoints.size();
+    parallelize(npoints, nthreads, [&](size_t i) -> void {
+        uint64_t start = index.checkpoints[i].uncompressed;
+        uint64_t end = (i + 1 < npoints ? index.checkpoints[i + 1].uncompressed : index.size);
+        GzipIndexedReader reader(path, index, start);
+        auto ptr = reinterpret_cast<unsigned char*>(buffer.data() + start);
+        uint64_t remaining = end - start;
+        while (remaining) {
+            size_t got = reader.read(ptr, std::min(remaining, static_cast<uint64_t>(gzip_chunk_size)));
+            if (got == 0) {
+                throw std::runtime_error("Gzip index does not match the contents of the file");
+            }
+            ptr += got;
+            remaining -= got;
+        }
+    });
+    return buffer;
+}
+
+}
+/**
+ * @endcond
+ */
+
+#endif
+
+}
+
+#endif
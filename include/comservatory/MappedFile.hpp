@@ -0,0 +1,119 @@
+#ifndef COMSERVATORY_MAPPEDFILE_HPP
+#define COMSERVATORY_MAPPEDFILE_HPP
+
+#include <string>
+#include <stdexcept>
+
+#if __has_include(<sys/mman.h>) && __has_include(<sys/stat.h>) && __has_include(<fcntl.h>) && __has_include(<unistd.h>)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define COMSERVATORY_HAS_MMAP 1
+#endif
+
+/**
+ * @file MappedFile.hpp
+ *
+ * @brief Defines the `MappedFile` class for memory-mapped input.
+ */
+
+namespace comservatory {
+
+#ifdef COMSERVATORY_HAS_MMAP
+
+/**
+ * @brief Read-only memory mapping of a file.
+ *
+ * This exposes the entire contents of a file as a single contiguous span of bytes,
+ * which can be parsed directly without any intermediate copies into a buffer.
+ * It is only available on systems that support POSIX `mmap()`, as indicated by the `COMSERVATORY_HAS_MMAP` macro.
+ */
+class MappedFile {
+public:
+    /**
+     * @param path Path to the file.
+     * @param huge_pages Whether to advise the kernel to back the mapping with transparent huge pages, where supported.
+     */
+    MappedFile(const char* path, bool huge_pages = false) {
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("failed to open file at '" + std::string(path) + "'");
+        }
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("failed to inspect file at '" + std::string(path) + "'");
+        }
+        my_size = info.st_size;
+
+        // Zero-length mappings are not allowed, so we just leave it as NULL.
+        if (my_size) {
+            void* ptr = ::mmap(NULL, my_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (ptr == MAP_FAILED) {
+                throw std::runtime_error("failed to memory-map file at '" + std::string(path) + "'");
+            }
+            my_data = static_cast<const char*>(ptr);
+
+            // These are only hints, so we don't care if they fail.
+            ::madvise(ptr, my_size, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+            if (huge_pages) {
+                ::madvise(ptr, my_size, MADV_HUGEPAGE);
+            }
+#else
+            (void)huge_pages;
+#endif
+        } else {
+            ::close(fd);
+        }
+    }
+
+    /**
+     * @param path Path to the file.
+     * @param huge_pages Whether to advise the kernel to back the mapping with transparent huge pages, where supported.
+     */
+    MappedFile(const std::string& path, bool huge_pages = false) : MappedFile(path.c_str(), huge_pages) {}
+
+    /**
+     * @cond
+     */
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        if (my_data) {
+            ::munmap(const_cast<char*>(my_data), my_size);
+        }
+    }
+    /**
+     * @endcond
+     */
+
+    /**
+     * @return Pointer to the start of the file contents.
+     * This may be `NULL` if the file is empty.
+     */
+    const char* data() const {
+        return my_data;
+    }
+
+    /**
+     * @return Size of the file in bytes.
+     */
+    size_t size() const {
+        return my_size;
+    }
+
+private:
+    const char* my_data = NULL;
+    size_t my_size = 0;
+};
+
+#endif
+
+}
+
+#endif
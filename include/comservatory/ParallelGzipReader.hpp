@@ -0,0 +1,264 @@
+#ifndef COMSERVATORY_PARALLELGZIPREADER_HPP
+#define COMSERVATORY_PARALLELGZIPREADER_HPP
+
+#if __has_include("zlib.h")
+
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <algorithm>
+
+#include "zlib.h"
+#include "byteme/Reader.hpp"
+#include "byteme/GzipFileReader.hpp"
+
+#include "parallelize.hpp"
+#include "GzipIndex.hpp"
+
+/**
+ * @file ParallelGzipReader.hpp
+ *
+ * @brief Defines the `ParallelGzipReader` class for multi-threaded decompression.
+ */
+
+namespace comservatory {
+
+/**
+ * @cond
+ */
+namespace internals {
+
+inline uint32_t read_le(const unsigned char* ptr, int nbytes) {
+    uint32_t output = 0;
+    for (int i = 0; i < nbytes; ++i) {
+        output |= static_cast<uint32_t>(ptr[i]) << (8 * i);
+    }
+    return output;
+}
+
+// Returns the total size of a BGZF block from its fixed header and extra
+// field, or 0 if the header is not from a BGZF block.
+inline size_t bgzf_block_size(const unsigned char* header, const unsigned char* extra, size_t xlen) {
+    if (header[0] != 0x1f || header[1] != 0x8b || header[2] != 8 || !(header[3] & 4)) {
+        return 0;
+    }
+
+    size_t i = 0;
+    while (i + 4 <= xlen) {
+        size_t slen = read_le(extra + i + 2, 2);
+        if (extra[i] == 'B' && extra[i + 1] == 'C' && slen == 2 && i + 6 <= xlen) {
+            return read_le(extra + i + 4, 2) + 1;
+        }
+        i += 4 + slen;
+    }
+    return 0;
+}
+
+constexpr size_t bgzf_header_size = 12;
+
+constexpr size_t bgzf_trailer_size = 8;
+
+// Reads the next BGZF block into 'block', returning false at the end of the file.
+inline bool read_bgzf_block(std::FILE* handle, std::vector<unsigned char>& block) {
+    block.resize(bgzf_header_size);
+    size_t got = std::fread(block.data(), 1, bgzf_header_size, handle);
+    if (got == 0) {
+        return false;
+    } else if (got != bgzf_header_size) {
+        throw std::runtime_error("BGZF file is truncated");
+    }
+
+    size_t xlen = read_le(block.data() + 10, 2);
+    block.resize(bgzf_header_size + xlen);
+    if (std::fread(block.data() + bgzf_header_size, 1, xlen, handle) != xlen) {
+        throw std::runtime_error("BGZF file is truncated");
+    }
+
+    size_t total = bgzf_block_size(block.data(), block.data() + bgzf_header_size, xlen);
+    if (total < bgzf_header_size + xlen + bgzf_trailer_size) {
+        throw std::runtime_error("expected a BGZF block in a blocked Gzip file");
+    }
+
+    size_t current = block.size();
+    block.resize(total);
+    if (std::fread(block.data() + current, 1, total - current, handle) != total - current) {
+        throw std::runtime_error("BGZF file is truncated");
+    }
+    return true;
+}
+
+// Decompresses a single BGZF block, checking its size and CRC.
+inline void inflate_bgzf_block(const std::vector<unsigned char>& block, std::vector<unsigned char>& output) {
+    size_t total = block.size();
+    const unsigned char* data = block.data();
+    unsigned char flags = data[3];
+
+    // Skipping the optional file name, comment and header CRC.
+    size_t start = bgzf_header_size + read_le(data + 10, 2);
+    size_t end = total - bgzf_trailer_size;
+    for (unsigned char f : { 8, 16 }) {
+        if (flags & f) {
+            while (start < end && data[start]) {
+                ++start;
+            }
+            ++start;
+        }
+    }
+    if (flags & 2) {
+        start += 2;
+    }
+    if (start > end) {
+        throw std::runtime_error("invalid header in BGZF block");
+    }
+
+    // Reserving an extra byte so that inflate() can make progress on empty
+    // blocks, and to detect blocks that are larger than their reported size.
+    size_t isize = read_le(data + end + 4, 4);
+    output.resize(isize + 1);
+    GzipStream gz(-15);
+    auto& strm = gz.stream;
+    strm.next_in = const_cast<unsigned char*>(data + start);
+    strm.avail_in = end - start;
+    strm.next_out = output.data();
+    strm.avail_out = output.size();
+    int ret = inflate(&strm, Z_FINISH);
+    output.pop_back();
+    if (ret != Z_STREAM_END || strm.avail_out != 1) {
+        throw std::runtime_error("invalid compressed data in BGZF block");
+    }
+
+    auto crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, output.data(), output.size());
+    if (crc != read_le(data + end, 4)) {
+        throw std::runtime_error("CRC mismatch in BGZF block");
+    }
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @brief Read a Gzipped file with multi-threaded decompression.
+ *
+ * Files that are compressed in independent blocks, i.e., in the BGZF format used by `bgzip` or `BlockedGzipWriter`, are decompressed in parallel.
+ * Batches of blocks are read from the file and inflated across multiple threads, and the decompressed data is returned in the original order.
+ * All other Gzipped files are decompressed with a single thread via `byteme::GzipFileReader`,
+ * as the boundaries of their members (if any) are not known without decompressing the entire file.
+ *
+ * Only available if Zlib is available.
+ */
+class ParallelGzipReader : public byteme::Reader {
+public:
+    /**
+     * @param path Path to a Gzipped file.
+     * @param num_threads Number of threads to use for decompression.
+     * @param blocks_per_thread Number of blocks to decompress in each thread per batch.
+     * Larger values reduce the overhead of parallelization but increase memory usage, as each block contains up to 64 KB of decompressed data.
+     */
+    ParallelGzipReader(const char* path, int num_threads, size_t blocks_per_thread = 16) :
+        file(path),
+        num_threads(std::max(num_threads, 1)),
+        batch_size(std::max(blocks_per_thread, static_cast<size_t>(1)) * this->num_threads)
+    {
+        // Peeking at the first block to see if it's BGZF.
+        unsigned char header[18];
+        size_t got = std::fread(header, 1, 18, file.handle);
+        bool bgzf = (got == 18 && internals::read_le(header + 10, 2) >= 6 && internals::bgzf_block_size(header, header + 12, 6) > 0);
+        if (!bgzf) {
+            fallback.reset(new byteme::GzipFileReader(path, {}));
+        } else if (std::fseek(file.handle, 0, SEEK_SET) != 0) {
+            throw std::runtime_error("failed to seek to the start of the file");
+        }
+    }
+
+    /**
+     * @param path Path to a Gzipped file.
+     * @param num_threads Number of threads to use for decompression.
+     * @param blocks_per_thread Number of blocks to decompress in each thread per batch.
+     */
+    ParallelGzipReader(const std::string& path, int num_threads, size_t blocks_per_thread = 16) : ParallelGzipReader(path.c_str(), num_threads, blocks_per_thread) {}
+
+    /**
+     * @cond
+     */
+    ParallelGzipReader(const ParallelGzipReader&) = delete;
+    ParallelGzipReader& operator=(const ParallelGzipReader&) = delete;
+    /**
+     * @endcond
+     */
+
+public:
+    /**
+     * @return Whether the file is in the BGZF format, such that it is decompressed in parallel.
+     */
+    bool blocked() const {
+        return !fallback;
+    }
+
+    /**
+     * @param buffer Pointer to an array of length `n`, to store the decompressed bytes.
+     * @param n Maximum number of bytes to read.
+     * @return Number of bytes read into `buffer`, which is only less than `n` at the end of the stream.
+     */
+    size_t read(unsigned char* buffer, size_t n) {
+        if (fallback) {
+            return fallback->read(buffer, n);
+        }
+
+        size_t filled = 0;
+        while (filled < n) {
+            if (current == used && !next_batch()) {
+                break;
+            }
+
+            const auto& block = decompressed[current];
+            size_t available = std::min(block.size() - position, n - filled);
+            std::copy_n(block.data() + position, available, buffer + filled);
+            filled += available;
+            position += available;
+            if (position == block.size()) {
+                ++current;
+                position = 0;
+            }
+        }
+
+        return filled;
+    }
+
+private:
+    bool next_batch() {
+        compressed.resize(batch_size);
+        decompressed.resize(batch_size);
+        used = 0;
+        while (used < batch_size && internals::read_bgzf_block(file.handle, compressed[used])) {
+            ++used;
+        }
+
+        parallelize(used, num_threads, [&](size_t b) -> void {
+            internals::inflate_bgzf_block(compressed[b], decompressed[b]);
+        });
+
+        current = 0;
+        position = 0;
+        return used > 0;
+    }
+
+    internals::GzipFileHandle file;
+    std::unique_ptr<byteme::GzipFileReader> fallback;
+
+    int num_threads;
+    size_t batch_size;
+    std::vector<std::vector<unsigned char> > compressed, decompressed;
+    size_t used = 0, current = 0, position = 0;
+};
+
+}
+
+#endif
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef COMSERVATORY_PARSESTATS_HPP
+#define COMSERVATORY_PARSESTATS_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#include "Type.hpp"
+#include "byteme/byteme.hpp"
+
+/**
+ * @file ParseStats.hpp
+ *
+ * @brief Defines the `ParseStats` class for statistics on a parse.
+ */
+
+namespace comservatory {
+
+/**
+ * @brief Statistics collected while reading a CSV file.
+ *
+ * These are useful for determining whether a slow read is limited by I/O (or decompression) or by parsing.
+ * See `ReadOptions::stats` for details.
+ */
+struct ParseStats {
+    /**
+     * Number of bytes of input that were parsed, including the header.
+     * This may be less than the size of the file if `ReadOptions::max_records` is set.
+     */
+    uint64_t bytes = 0;
+
+    /**
+     * Number of records that were parsed, excluding the header and any skipped records.
+     */
+    uint64_t records = 0;
+
+    /**
+     * Number of fields that were parsed, i.e., the number of records multiplied by the number of fields in each record.
+     */
+    uint64_t fields = 0;
+
+    /**
+     * Number of non-missing values of each type, indexed by `Type`.
+     * Values are counted by the type in which they were written, e.g., integers are counted as `INTEGER` if `ReadOptions::detect_integers = true`,
+     * even if they are later stored in a `NUMBER` field.
+     * Values that were only checked for their boundaries with `ValidationLevel::STRUCTURE` are counted as `UNKNOWN`.
+     */
+    std::array<uint64_t, 6> values{};
+
+    /**
+     * Number of missing values.
+     */
+    uint64_t missing = 0;
+
+    /**
+     * Time spent waiting for input from the reader, in seconds.
+     * This includes the time spent in I/O and decompression, excluding any time that overlaps with parsing when `ReadOptions::parallel = true`.
+     * For memory-mapped files, I/O occurs during parsing and is not included here.
+     */
+    double read_time = 0;
+
+    /**
+     * Time spent parsing the input, in seconds.
+     */
+    double parse_time = 0;
+
+    /**
+     * Peak number of bytes of input that were held in memory, including any read-ahead buffers.
+     * If the entire input is loaded or mapped into memory, this is equal to its size.
+     */
+    uint64_t peak_buffered = 0;
+};
+
+/**
+ * @cond
+ */
+namespace internals {
+
+inline double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Wraps another reader to record the time spent waiting in read().
+class TimedReader : public byteme::Reader {
+public:
+    TimedReader(byteme::Reader* source) : source(source) {}
+
+    size_t read(unsigned char* buffer, size_t n) {
+        auto start = std::chrono::steady_clock::now();
+        size_t got = source->read(buffer, n);
+        elapsed += seconds_since(start);
+        return got;
+    }
+
+    double elapsed = 0;
+
+private:
+    byteme::Reader* source;
+};
+
+}
+/**
+ * @endcond
+ */
+
+}
+
+#endif
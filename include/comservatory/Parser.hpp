@@ -8,10 +8,17 @@
 #include <algorithm>
 #include <memory>
 #include <thread>
+#include <functional>
 
 #include "convert.hpp"
+#include "input.hpp"
+#include "scan.hpp"
+#include "parallelize.hpp"
 #include "Field.hpp"
 #include "Creator.hpp"
+#include "RecordIndex.hpp"
+#include "ParseStats.hpp"
+#include "ReadProgress.hpp"
 
 #include "byteme/byteme.hpp"
 
@@ -31,6 +38,27 @@ struct Parser;
  * @endcond
  */
 
+/**
+ * Level of validation for the values of a field.
+ */
+enum class ValidationLevel {
+    /**
+     * Values are fully parsed and checked against the type of the field.
+     */
+    FULL,
+
+    /**
+     * Values are checked against the grammar for the type of the field, but numbers are not converted and strings are not stored.
+     */
+    GRAMMAR,
+
+    /**
+     * Values are only checked for the boundaries between fields, i.e., that they are non-empty and that any strings are terminated.
+     * The type of the field is still determined from its first non-missing value.
+     */
+    STRUCTURE
+};
+
 /**
  * @brief The parsed contents of a CSV file.
  */
@@ -46,6 +74,13 @@ struct Contents {
      */
     std::vector<std::string> names;
 
+    /**
+     * Owner of the input buffer, if any of the `fields` refer to it directly, e.g., via `StringViewField`.
+     * This is set by `read_file()` and `read()` when they allocate or map the buffer themselves,
+     * and is left unchanged when parsing a user-supplied buffer, e.g., with `read_buffer()`.
+     */
+    std::shared_ptr<void> backing;
+
     /**
      * @return Number of fields in the CSV file.
      */
@@ -78,6 +113,48 @@ public:
         return *this;
     }
 
+    Parser& set_detect_integers(bool d = false) {
+        detect_integers = d;
+        return *this;
+    }
+
+    Parser& set_dummy_validation(ValidationLevel v = ValidationLevel::FULL) {
+        dummy_validation = v;
+        return *this;
+    }
+
+    Parser& set_skip_records(size_t n = 0) {
+        skip_records = n;
+        return *this;
+    }
+
+    Parser& set_max_records(size_t n = std::numeric_limits<size_t>::max()) {
+        max_records = n;
+        return *this;
+    }
+
+    Parser& set_record_index(RecordIndex* index = nullptr) {
+        record_index = index;
+        return *this;
+    }
+
+    Parser& set_split_index(const RecordIndex* index = nullptr) {
+        split_index = index;
+        return *this;
+    }
+
+    Parser& set_stats(ParseStats* s = nullptr) {
+        stats = s;
+        return *this;
+    }
+
+    Parser& set_progress(const std::function<bool(const ReadProgress&)>* fun = nullptr, uint64_t bytes = 0, uint64_t records = 0) {
+        progress = (fun && *fun ? fun : nullptr);
+        progress_bytes = bytes;
+        progress_records = records;
+        return *this;
+    }
+
     template<class NameIter>
     Parser& set_store_by_name(NameIter start, NameIter end) {
         to_store_by_name = std::unordered_set<std::string>(start, end);
@@ -100,6 +177,16 @@ public:
         return set_store_by_index(k.begin(), k.end());
     }
 
+public:
+    // Creates a new field for 'column' with 'n' missing values, which is a
+    // dummy if the column is not to be stored.
+    Field* create_field(const Contents& info, Type observed, size_t column, size_t n) const {
+        bool use_dummy = check_store && 
+            to_store_by_name.find(info.names[column]) == to_store_by_name.end() &&
+            to_store_by_index.find(column) == to_store_by_index.end();
+        return creator->create(observed, n, use_dummy);
+    }
+
 private:
     static Field* fetch_column(Contents& info, size_t column, size_t line) {
         auto& everything = info.fields;
@@ -114,11 +201,15 @@ private:
         auto expected = current->type();
 
         if (expected == UNKNOWN) {
-            bool use_dummy = check_store && 
-                to_store_by_name.find(info.names[column]) == to_store_by_name.end() &&
-                to_store_by_index.find(column) == to_store_by_index.end();
-
-            auto ptr = creator->create(observed, current->size(), use_dummy);
+            auto ptr = create_field(info, observed, column, current->size());
+            info.fields[column].reset(ptr);
+            current = info.fields[column].get();
+            if (resolved_at) {
+                (*resolved_at)[column] = line;
+            }
+        } else if (expected == INTEGER && observed == NUMBER && detect_integers) {
+            // Promoting the field once if it turns out to contain non-integers.
+            auto ptr = creator->promote(current, NUMBER);
             info.fields[column].reset(ptr);
             current = info.fields[column].get();
         } else if (expected != observed) {
@@ -128,110 +219,484 @@ private:
         return current;
     }
 
-    template<class Input>
-    void store_nan(Input& input, Contents& info, size_t column, size_t line) const {
-        input.advance();
-        expect_fixed(input, "an", "AN", column, line); // i.e., NaN or any of its capitalizations.
-        auto* current = check_column_type(info, NUMBER, column, line);
-        static_cast<NumberField*>(current)->push_back(std::numeric_limits<double>::quiet_NaN());
+private:
+    // Values are staged for each column and added to the Field in bulk, to
+    // avoid a virtual call for each value. Each Stage also caches the type
+    // of its Field, so check_column_type() is only called when the type
+    // changes. At most one of 'missing' or 'used' is non-zero at any time.
+    static constexpr size_t stage_size = 64;
+
+    struct Stage {
+        Type type = UNKNOWN; // i.e., not yet checked.
+        bool dummy = false;
+        size_t missing = 0;
+        size_t used = 0;
+        std::vector<double> numbers;
+        std::vector<int64_t> integers;
+        std::unique_ptr<bool[]> booleans;
+        std::vector<std::complex<double> > complexes;
+    };
+
+    static Stage& fetch_stage(std::vector<Stage>& stages, size_t column, size_t line) {
+        if (column >= stages.size()) {
+            throw std::runtime_error("more fields on line " + std::to_string(line + 1) + " than expected from the header");
+        }
+        return stages[column];
     }
 
-    template<class Input>
-    void store_inf(Input& input, Contents& info, size_t column, size_t line, bool negative) const {
-        input.advance();
-        expect_fixed(input, "nf", "NF", column, line); // i.e., Inf or any of its capitalizations.
-        auto* current = check_column_type(info, NUMBER, column, line);
+    static void flush_stage(Stage& stage, Field* field) {
+        if (stage.missing) {
+            field->add_missing_many(stage.missing);
+            stage.missing = 0;
+            return;
+        } 
 
-        double val = std::numeric_limits<double>::infinity();
-        if (negative) {
-            val *= -1;
+        if (stage.used) {
+            switch (stage.type) {
+                case NUMBER:
+                    static_cast<NumberField*>(field)->push_back_many(stage.numbers.data(), stage.used);
+                    break;
+                case INTEGER:
+                    static_cast<IntegerField*>(field)->push_back_many(stage.integers.data(), stage.used);
+                    break;
+                case BOOLEAN:
+                    static_cast<BooleanField*>(field)->push_back_many(stage.booleans.get(), stage.used);
+                    break;
+                case COMPLEX:
+                    static_cast<ComplexField*>(field)->push_back_many(stage.complexes.data(), stage.used);
+                    break;
+                default:
+                    break;
+            }
+            stage.used = 0;
         }
-        static_cast<NumberField*>(current)->push_back(val);
     }
 
-    template<class Input>
-    void store_na_or_nan(Input& input, Contents& info, size_t column, size_t line) const {
-        // Some shenanigans required here to distinguish between
-        // NAN/NaN/etc. and NA, given that both are allowed.
-        input.advance();
-        if (!input.valid()) {
-            throw std::runtime_error("truncated keyword in " + get_location(column, line));
+    static void flush_stages(std::vector<Stage>& stages, Contents& info) {
+        for (size_t c = 0, end = stages.size(); c < end; ++c) {
+            flush_stage(stages[c], info.fields[c].get());
         }
+    }
+
+    // Flushes the stage and checks the type of the underlying field.
+    Field* restage(std::vector<Stage>& stages, Contents& info, Type observed, size_t column, size_t line) const {
+        auto& stage = fetch_stage(stages, column, line);
+        flush_stage(stage, info.fields[column].get());
+        auto current = check_column_type(info, observed, column, line);
 
-        char second = input.get();
-        bool is_missing = true;
-        if (second == 'a') {
-            is_missing = false;
-        } else if (second != 'A') {
-            throw std::runtime_error("unknown keyword in " + get_location(column, line));
+        stage.type = observed;
+        stage.dummy = !current->filled();
+        switch (observed) {
+            case NUMBER:
+                stage.numbers.resize(stage_size);
+                break;
+            case INTEGER:
+                stage.integers.resize(stage_size);
+                break;
+            case BOOLEAN:
+                if (!stage.booleans) {
+                    stage.booleans.reset(new bool[stage_size]);
+                }
+                break;
+            case COMPLEX:
+                stage.complexes.resize(stage_size);
+                break;
+            default:
+                break;
         }
 
-        input.advance();
-        if (!input.valid()) {
-            if (is_missing) {
-                throw std::runtime_error("line " + std::to_string(line + 1) + " should terminate with a newline");
-            } else {
-                throw std::runtime_error("truncated keyword in " + get_location(column, line));
-            }
+        return current;
+    }
+
+    template<typename T, Type tt>
+    static T* stage_buffer(Stage& stage) {
+        if constexpr(tt == NUMBER) {
+            return stage.numbers.data();
+        } else if constexpr(tt == INTEGER) {
+            return stage.integers.data();
+        } else if constexpr(tt == BOOLEAN) {
+            return stage.booleans.get();
+        } else {
+            return stage.complexes.data();
+        }
+    }
+
+    template<typename T, Type tt>
+    void store_value(std::vector<Stage>& stages, Contents& info, size_t column, size_t line, T value) const {
+        auto& stage = fetch_stage(stages, column, line);
+        if (stage.type != tt) {
+            restage(stages, info, tt, column, line);
+        } else if (stage.missing) {
+            flush_stage(stage, info.fields[column].get());
+        }
+
+        stage_buffer<T, tt>(stage)[stage.used] = value;
+        ++stage.used;
+        if (stage.used == stage_size) {
+            flush_stage(stage, info.fields[column].get());
         }
+    }
+
+    void store_missing(std::vector<Stage>& stages, Contents& info, size_t column, size_t line) const {
+        auto& stage = fetch_stage(stages, column, line);
+        if (stage.used) {
+            flush_stage(stage, info.fields[column].get());
+        }
+        ++stage.missing;
+    }
 
-        char next = input.get();
-        if (next == 'n' || next == 'N') {
-            auto* current = check_column_type(info, NUMBER, column, line);
-            static_cast<NumberField*>(current)->push_back(std::numeric_limits<double>::quiet_NaN());
-            input.advance(); // for consistency with the NA case, in the sense that we are always past the keyword regardless of whether the keyword is NaN or NA.
-        } else if (is_missing) {
-            auto raw = fetch_column(info, column, line);
-            raw->add_missing();
+    void store_integer(std::vector<Stage>& stages, Contents& info, size_t column, size_t line, int64_t value) const {
+        auto& stage = fetch_stage(stages, column, line);
+        if (stage.type == INTEGER) {
+            store_value<int64_t, INTEGER>(stages, info, column, line, value);
+        } else if (stage.type == NUMBER || info.fields[column]->type() == NUMBER) { // i.e., after promotion, or if the field was supplied as NUMBER.
+            store_value<double, NUMBER>(stages, info, column, line, value);
         } else {
-            throw std::runtime_error("unknown keyword in " + get_location(column, line));
+            store_value<int64_t, INTEGER>(stages, info, column, line, value);
         }
     }
 
+    // Destination for the values in parse_records(), which stages them
+    // before adding them to the fields of a Contents.
+    struct ContentsStore {
+        ContentsStore(const Parser& parser, Contents& info) : parser(parser), info(info), stages(info.fields.size()) {}
+
+        size_t num_fields() const {
+            return info.names.size();
+        }
+
+        // Values in dummy fields are not stored, so we can skip some or all of
+        // the conversion once the type of the field is known.
+        ValidationLevel validation(size_t column) const {
+            if (column < stages.size() && stages[column].dummy) {
+                return parser.dummy_validation;
+            }
+            return ValidationLevel::FULL;
+        }
+
+        template<class Input>
+        void add_string(Input& input, size_t column, size_t line) {
+            // Strings are not staged as they're appended directly to the field.
+            StringField* current;
+            auto& stage = fetch_stage(stages, column, line);
+            if (stage.type == STRING) {
+                current = static_cast<StringField*>(info.fields[column].get());
+                if (stage.missing) {
+                    flush_stage(stage, current);
+                }
+            } else {
+                current = static_cast<StringField*>(parser.restage(stages, info, STRING, column, line));
+            }
+
+            if (stage.dummy && parser.dummy_validation != ValidationLevel::FULL) {
+                skip_string(input, column, line);
+                current->push_back(std::string());
+                return;
+            }
+
+            if constexpr(std::is_same<Input, BufferInput>::value) {
+                if (current->use_views()) {
+                    bool escaped;
+                    auto view = to_string_view(input, column, line, scratch, escaped);
+                    current->push_back_view(view, !escaped);
+                    return;
+                }
+            }
+
+            auto* buffer = current->start_append();
+            if (buffer) {
+                to_string(input, column, line, *buffer);
+                current->finish_append();
+            } else {
+                current->push_back(to_string(input, column, line));
+            }
+        }
+
+        template<typename T, Type tt>
+        void add_value(size_t column, size_t line, T value) {
+            parser.store_value<T, tt>(stages, info, column, line, value);
+        }
+
+        void add_integer(size_t column, size_t line, int64_t value) {
+            parser.store_integer(stages, info, column, line, value);
+        }
+
+        void add_missing(size_t column, size_t line) {
+            parser.store_missing(stages, info, column, line);
+        }
+
+        // Adds a placeholder for a value that was skipped by skip_field().
+        void add_skipped(size_t column, size_t line) {
+            switch (stages[column].type) {
+                case NUMBER:
+                    add_value<double, NUMBER>(column, line, 0);
+                    break;
+                case INTEGER:
+                    add_value<int64_t, INTEGER>(column, line, 0);
+                    break;
+                case BOOLEAN:
+                    add_value<bool, BOOLEAN>(column, line, false);
+                    break;
+                case COMPLEX:
+                    add_value<std::complex<double>, COMPLEX>(column, line, 0);
+                    break;
+                default:
+                    {
+                        auto& stage = stages[column];
+                        auto current = static_cast<StringField*>(info.fields[column].get());
+                        if (stage.missing) {
+                            flush_stage(stage, current);
+                        }
+                        current->push_back(std::string());
+                    }
+                    break;
+            }
+        }
+
+        void finish_record(size_t) {}
+
+        void finish() {
+            flush_stages(stages, info);
+        }
+
+        const Parser& parser;
+        Contents& info;
+        std::vector<Stage> stages;
+        std::string scratch;
+    };
+
+    // Wraps another store to count the values of each type. This is only
+    // used if statistics are requested, so that there is no overhead in the
+    // usual instantiation of parse_records().
+    template<class Store>
+    struct StatsStore {
+        StatsStore(Store& store, ParseStats& stats) : store(store), stats(stats) {}
+
+        size_t num_fields() const {
+            return store.num_fields();
+        }
+
+        ValidationLevel validation(size_t column) const {
+            return store.validation(column);
+        }
+
+        template<class Input>
+        void add_string(Input& input, size_t column, size_t line) {
+            ++stats.values[STRING];
+            store.add_string(input, column, line);
+        }
+
+        template<typename T, Type tt>
+        void add_value(size_t column, size_t line, T value) {
+            ++stats.values[tt];
+            store.template add_value<T, tt>(column, line, std::move(value));
+        }
+
+        void add_integer(size_t column, size_t line, int64_t value) {
+            ++stats.values[INTEGER];
+            store.add_integer(column, line, value);
+        }
+
+        void add_missing(size_t column, size_t line) {
+            ++stats.missing;
+            store.add_missing(column, line);
+        }
+
+        void add_skipped(size_t column, size_t line) {
+            ++stats.values[UNKNOWN];
+            store.add_skipped(column, line);
+        }
+
+        void finish_record(size_t line) {
+            store.finish_record(line);
+        }
+
+        void finish() {
+            store.finish();
+        }
+
+        Store& store;
+        ParseStats& stats;
+    };
+
+    // Wraps another store to report progress to a tracker after every
+    // 'progress_records' records or 'progress_bytes' bytes. Like StatsStore,
+    // this is only used if a progress callback is supplied.
+    template<class Store, class Input>
+    struct ProgressStore {
+        ProgressStore(Store& store, const Input& input, internals::ProgressTracker& tracker, uint64_t bytes, uint64_t records) :
+            store(store), input(input), tracker(tracker), step_bytes(bytes), step_records(records), last_position(input.position()) {}
+
+        size_t num_fields() const {
+            return store.num_fields();
+        }
+
+        ValidationLevel validation(size_t column) const {
+            return store.validation(column);
+        }
+
+        template<class Input_>
+        void add_string(Input_& in, size_t column, size_t line) {
+            store.add_string(in, column, line);
+        }
+
+        template<typename T, Type tt>
+        void add_value(size_t column, size_t line, T value) {
+            store.template add_value<T, tt>(column, line, std::move(value));
+        }
+
+        void add_integer(size_t column, size_t line, int64_t value) {
+            store.add_integer(column, line, value);
+        }
+
+        void add_missing(size_t column, size_t line) {
+            store.add_missing(column, line);
+        }
+
+        void add_skipped(size_t column, size_t line) {
+            store.add_skipped(column, line);
+        }
+
+        void finish_record(size_t line) {
+            store.finish_record(line);
+            ++pending;
+            if ((step_records && pending >= step_records) || (step_bytes && input.position() - last_position >= step_bytes)) {
+                flush();
+            }
+        }
+
+        void finish() {
+            store.finish();
+        }
+
+        void flush() {
+            uint64_t position = input.position();
+            bool okay = tracker.report(position - last_position, pending);
+            last_position = position;
+            pending = 0;
+            if (!okay) {
+                throw ReadCancelled();
+            }
+        }
+
+        Store& store;
+        const Input& input;
+        internals::ProgressTracker& tracker;
+        uint64_t step_bytes, step_records;
+        uint64_t last_position;
+        uint64_t pending = 0;
+    };
+
     template<class Input>
-    void store_number_or_complex(Input& input, Contents& info, size_t column, size_t line, bool negative) const {
-        auto first = to_number(input, column, line);
-        if (negative) {
-            first *= -1;
+    void parse_contents(Input& input, Contents& info, size_t& line, ParseStats* counts) const {
+        ContentsStore store(*this, info);
+        if (progress) {
+            internals::ProgressTracker tracker(*progress, input.position());
+            ProgressStore<ContentsStore, Input> tracked(store, input, tracker, progress_bytes, progress_records);
+            try {
+                parse_counted(input, tracked, line, counts);
+            } catch (ReadCancelled&) {
+                clear_contents(info);
+                throw;
+            }
+        } else {
+            parse_counted(input, store, line, counts);
         }
+    }
 
-        char next = input.get(); // no need to check validity, as to_number always leaves us on a valid position (or throws itself).
-        if (next == ',' || next == '\n') {
-            auto* current = check_column_type(info, NUMBER, column, line);
-            static_cast<NumberField*>(current)->push_back(first);
-            return;
+    template<class Input, class Store>
+    void parse_counted(Input& input, Store& store, size_t& line, ParseStats* counts) const {
+        if (counts) {
+            StatsStore<Store> wrapped(store, *counts);
+            parse_limited(input, wrapped, line);
+        } else {
+            parse_limited(input, store, line);
         }
+    }
 
-        char second_neg = false;
-        if (next == '-') {
-            second_neg = true;
-        } else if (next != '+') {
-            throw std::runtime_error("incorrectly formatted number in " + get_location(column, line));
+    template<class Store>
+    void parse_chunk(BufferInput& input, Store& store, size_t& line, ParseStats* counts) const {
+        if (counts) {
+            StatsStore<Store> wrapped(store, *counts);
+            parse_records(input, wrapped, line);
+        } else {
+            parse_records(input, store, line);
         }
+    }
+
+    // Discards the partial contents of a cancelled read.
+    static void clear_contents(Contents& info) {
+        info.fields.clear();
+        info.names.clear();
+        info.backing.reset();
+        info.fallback = 0;
+    }
 
+    template<class Input, class Store>
+    void store_nan(Input& input, Store& store, size_t column, size_t line) const {
         input.advance();
-        if (!input.valid()) {
-            throw std::runtime_error("truncated complex number in " + get_location(column, line));
-        } else if (!std::isdigit(input.get())) {
-            throw std::runtime_error("incorrectly formatted complex number in " + get_location(column, line));
+        expect_fixed(input, "an", "AN", column, line); // i.e., NaN or any of its capitalizations.
+        store.template add_value<double, NUMBER>(column, line, std::numeric_limits<double>::quiet_NaN());
+    }
+
+    template<class Input, class Store>
+    void store_inf(Input& input, Store& store, size_t column, size_t line, bool negative) const {
+        input.advance();
+        expect_fixed(input, "nf", "NF", column, line); // i.e., Inf or any of its capitalizations.
+
+        double val = std::numeric_limits<double>::infinity();
+        if (negative) {
+            val *= -1;
+        }
+        store.template add_value<double, NUMBER>(column, line, val);
+    }
+
+    template<class Input, class Store>
+    void store_na_or_nan(Input& input, Store& store, size_t column, size_t line) const {
+        if (to_missing_or_nan(input, column, line)) {
+            store.add_missing(column, line);
+        } else {
+            store.template add_value<double, NUMBER>(column, line, std::numeric_limits<double>::quiet_NaN());
         }
+    }
 
-        auto second = to_number(input, column, line);
-        if (second_neg) {
-            second *= -1;
+    template<class Input, class Store>
+    void store_number_or_complex(Input& input, Store& store, size_t column, size_t line, bool negative) const {
+        IntegerCapture integer;
+        bool skip = (store.validation(column) != ValidationLevel::FULL);
+        double first = 0;
+        if (skip) {
+            skip_number(input, column, line, detect_integers ? &integer : NULL);
+            integer.magnitude = 0; // the type is all that matters.
+        } else {
+            first = to_number(input, column, line, detect_integers ? &integer : NULL);
+        }
+        if (negative) {
+            first *= -1;
         }
-        if (input.get() != 'i') { // again, no need to check validity.
-            throw std::runtime_error("incorrectly formatted complex number in " + get_location(column, line));
+
+        char next = input.get(); // no need to check validity, as to_number always leaves us on a valid position (or throws itself).
+        if (next == ',' || next == '\n') {
+            int64_t value;
+            if (to_int64(integer, negative, value)) {
+                store.add_integer(column, line, value);
+                return;
+            }
+
+            // Otherwise, integers that are too large are treated as doubles.
+            store.template add_value<double, NUMBER>(column, line, first);
+            return;
         }
-        input.advance(); // for consistency with the numbers, in the sense that we are always past the keyword regardless of whether we're a NUMBER or COMPLEX.
 
-        auto* current = check_column_type(info, COMPLEX, column, line);
-        static_cast<ComplexField*>(current)->push_back(std::complex<double>(first, second));
+        auto second = to_imaginary(input, column, line, skip);
+        store.template add_value<std::complex<double>, COMPLEX>(column, line, std::complex<double>(first, second));
     }
 
-private:
+public:
+    // Returns whether there are any records remaining after the header.
+    // This is also used by read_typed() to obtain the names.
     template<class Input>
-    void parse_loop(Input& input, Contents& info) const {
+    bool parse_header(Input& input, Contents& info) const {
         if (!input.valid()) {
             throw std::runtime_error("CSV file is empty");
         }
@@ -249,7 +714,7 @@ private:
                     throw std::runtime_error("more fields on line " + std::to_string(line + 1) + " than expected from the header");
                 }
             }
-            return;
+            return false;
         }
 
         // Processing the header.
@@ -306,91 +771,107 @@ private:
         }
 
         // Special case if there are no records, i.e., it's header-only.
-        if (!input.valid()) {
-            return;
-        }
+        return input.valid();
+    }
 
-        // Processing the records in a CSV.
-        size_t column = 0;
-        size_t line = 1;
-        while (1) {
-            switch (input.get()) {
-                case '"':
-                    {
-                        auto* current = check_column_type(info, STRING, column, line);
-                        static_cast<StringField*>(current)->push_back(to_string(input, column, line));
-                    }
-                    break;
+private:
+    // Parses a single value starting at the current position of 'input'. On
+    // return, 'input' is left on the first character after the value.
+    template<class Input, class Store>
+    void parse_value(Input& input, Store& store, size_t column, size_t line) const {
+        switch (input.get()) {
+            case '"':
+                store.add_string(input, column, line);
+                break;
 
-                case 't': case 'T':
-                    {
-                        input.advance();
-                        expect_fixed(input, "rue", "RUE", column, line);
-                        auto* current = check_column_type(info, BOOLEAN, column, line);
-                        static_cast<BooleanField*>(current)->push_back(true);
-                    }
-                    break;
+            case 't': case 'T':
+                {
+                    input.advance();
+                    expect_fixed(input, "rue", "RUE", column, line);
+                    store.template add_value<bool, BOOLEAN>(column, line, true);
+                }
+                break;
 
-                case 'f': case 'F':
-                    {
-                        input.advance();
-                        expect_fixed(input, "alse", "ALSE", column, line);
-                        auto* current = check_column_type(info, BOOLEAN, column, line);
-                        static_cast<BooleanField*>(current)->push_back(false);
-                    }
-                    break;
+            case 'f': case 'F':
+                {
+                    input.advance();
+                    expect_fixed(input, "alse", "ALSE", column, line);
+                    store.template add_value<bool, BOOLEAN>(column, line, false);
+                }
+                break;
 
-                case 'N':
-                    store_na_or_nan(input, info, column, line);
-                    break;
+            case 'N':
+                store_na_or_nan(input, store, column, line);
+                break;
 
-                case 'n': 
-                    store_nan(input, info, column, line);
-                    break;
-                
-                case 'i': case 'I':
-                    store_inf(input, info, column, line, false);
-                    break;
+            case 'n': 
+                store_nan(input, store, column, line);
+                break;
+        
+            case 'i': case 'I':
+                store_inf(input, store, column, line, false);
+                break;
 
-                case '0': case '1': case '2': case '3': case '4': case '5': case '6': case '7': case '8': case '9':
-                    store_number_or_complex(input, info, column, line, false);
-                    break;
+            case '0': case '1': case '2': case '3': case '4': case '5': case '6': case '7': case '8': case '9':
+                store_number_or_complex(input, store, column, line, false);
+                break;
 
-                case '+':
+            case '+':
+                input.advance();
+                if (!input.valid()) {
+                    throw std::runtime_error("truncated field in " + get_location(column, line)); 
+                } else if (!std::isdigit(input.get())) {
+                    throw std::runtime_error("invalid number in " + get_location(column, line)); 
+                }
+                store_number_or_complex(input, store, column, line, false);
+                break;
+
+            case '-':
+                {
                     input.advance();
                     if (!input.valid()) {
-                        throw std::runtime_error("truncated field in " + get_location(column, line)); 
-                    } else if (!std::isdigit(input.get())) {
-                        throw std::runtime_error("invalid number in " + get_location(column, line)); 
+                        throw std::runtime_error("truncated field in " + get_location(column, line));
                     }
-                    store_number_or_complex(input, info, column, line, false);
-                    break;
-
-                case '-':
-                    {
-                        input.advance();
-                        if (!input.valid()) {
-                            throw std::runtime_error("truncated field in " + get_location(column, line));
-                        }
 
-                        char next = input.get();
-                        if (next == 'i' || next == 'I') {
-                            store_inf(input, info, column, line, true);
-                        } else if (next == 'n' || next == 'N') {
-                            store_nan(input, info, column, line);
-                        } else if (std::isdigit(next)) {
-                            store_number_or_complex(input, info, column, line, true);
-                        } else {
-                            throw std::runtime_error("incorrectly formatted number in " + get_location(column, line));
-                        }
+                    char next = input.get();
+                    if (next == 'i' || next == 'I') {
+                        store_inf(input, store, column, line, true);
+                    } else if (next == 'n' || next == 'N') {
+                        store_nan(input, store, column, line);
+                    } else if (std::isdigit(next)) {
+                        store_number_or_complex(input, store, column, line, true);
+                    } else {
+                        throw std::runtime_error("incorrectly formatted number in " + get_location(column, line));
                     }
-                    break;
+                }
+                break;
 
-                case '\n':
-                    throw std::runtime_error(get_location(column, line) + " is empty");
+            case '\n':
+                throw std::runtime_error(get_location(column, line) + " is empty");
 
-                default:
-                    throw std::runtime_error("unknown type starting with '" + std::string(1, input.get()) + "' in " + get_location(column, line));
+            default:
+                throw std::runtime_error("unknown type starting with '" + std::string(1, input.get()) + "' in " + get_location(column, line));
+        }
+    }
+
+public:
+    // Processing the records in a CSV. 'line' should contain the index of the
+    // first record (where the header is line 0); on return or throw, it
+    // contains the index of the last record that was processed. At most
+    // 'limit' records are processed, after which 'input' is left at the start
+    // of the next record (if any). Each value is
+    // passed to 'store', which should implement the same methods as
+    // ContentsStore; this allows the same validation to be used for other
+    // destinations, e.g., the streaming visitors in visit.hpp.
+    template<class Input, class Store>
+    void parse_records(Input& input, Store& store, size_t& line, size_t limit = std::numeric_limits<size_t>::max()) const {
+        size_t column = 0;
+        while (1) {
+            if (store.validation(column) == ValidationLevel::STRUCTURE) {
+                skip_field(input, column, line);
+                store.add_skipped(column, line);
+            } else {
+                parse_value(input, store, column, line);
             }
 
             if (!input.valid()) {
@@ -405,10 +886,15 @@ private:
                     throw std::runtime_error("line " + std::to_string(line + 1) + " is truncated at column " + std::to_string(column + 1));
                 }
             } else if (next == '\n') {
-                if (column + 1 != info.names.size()) {
+                if (column + 1 != store.num_fields()) {
                     throw std::runtime_error("line " + std::to_string(line + 1) + " has fewer fields than expected from the header");
                 }
-                if (!input.valid()) {
+                store.finish_record(line);
+                if (record_index && line % record_index->interval == 0) {
+                    record_index->offsets.push_back(input.position()); // i.e., the start of the 'line'-th record, counting from zero.
+                }
+                --limit;
+                if (!input.valid() || limit == 0) {
                     break;
                 }
                 column = 0;
@@ -417,25 +903,575 @@ private:
                 throw std::runtime_error(get_location(column, line) + " contains trailing character '" + std::string(1, next) + "'"); 
             }
         }
+
+        store.finish();
+    }
+
+    template<class Input>
+    void parse_records(Input& input, Contents& info, size_t& line, size_t limit = std::numeric_limits<size_t>::max()) const {
+        ContentsStore store(*this, info);
+        parse_records(input, store, line, limit);
+    }
+
+    // Skips up to 'n' records without any validation beyond tracking the
+    // quote state. Returns the number of records that were skipped.
+    template<class Input>
+    static size_t skip_ahead(Input& input, size_t n) {
+        if (n == 0) {
+            return 0;
+        }
+
+        size_t skipped = 0;
+        if constexpr(std::is_same<Input, BufferInput>::value) {
+            input.current = advance_records(input.current, input.end, n, skipped);
+        } else {
+            bool in_quotes = false;
+            while (input.valid()) {
+                char c = input.get();
+                input.advance();
+                if (c == '"') {
+                    in_quotes = !in_quotes;
+                } else if (c == '\n' && !in_quotes) {
+                    ++skipped;
+                    if (skipped == n) {
+                        break;
+                    }
+                }
+            }
+        }
+        return skipped;
+    }
+
+    // Parses the records after the header, subject to 'skip_records' and
+    // 'max_records'. Parsing stops as soon as the limit is reached, so any
+    // subsequent records are not read from 'input'.
+    template<class Input, class Store>
+    void parse_limited(Input& input, Store& store, size_t& line) const {
+        line += skip_ahead(input, skip_records);
+        if (input.valid() && max_records) {
+            parse_records(input, store, line, max_records);
+        }
+    }
+
+private:
+    // Applies the limits to the number of records in a file without any fields.
+    void limit_fallback(Contents& info) const {
+        auto& n = info.fallback;
+        n = (n > skip_records ? n - skip_records : 0);
+        n = std::min(n, max_records);
+    }
+
+    // Resets the index at the start of the first record. We don't support
+    // partial indices, as these would not be consistent with the file size.
+    void start_index(uint64_t header_end) const {
+        if (skip_records || max_records != std::numeric_limits<size_t>::max()) {
+            throw std::runtime_error("record index cannot be built when skipping or limiting records");
+        }
+        if (record_index->interval == 0) {
+            throw std::runtime_error("record index interval should be positive");
+        }
+        record_index->offsets.clear();
+        record_index->offsets.push_back(header_end);
+    }
+
+    // Discards the offset at the end of the file if the last record was
+    // sampled, and stores the schema for later use in read_rows().
+    void finish_index(uint64_t size, size_t nrecords, const Contents& info) const {
+        auto interval = record_index->interval;
+        record_index->offsets.resize((nrecords + interval - 1) / interval);
+        record_index->num_records = nrecords;
+        record_index->size = size;
+
+        record_index->names = info.names;
+        record_index->types.clear();
+        for (const auto& f : info.fields) {
+            record_index->types.push_back(f->type());
+        }
+    }
+
+    template<class Input>
+    void parse_loop(Input& input, Contents& info) const {
+        bool remaining = parse_header(input, info);
+        if (record_index) {
+            start_index(input.position());
+        }
+
+        size_t line = 0;
+        if (remaining) {
+            line = 1;
+            parse_contents(input, info, line, stats);
+        } else if (info.names.empty()) {
+            limit_fallback(info);
+        }
+
+        if (record_index) {
+            finish_index(input.position(), line, info);
+        }
+        if (stats) {
+            finish_stats(input.position(), info);
+        }
+    }
+
+    void finish_stats(uint64_t bytes, const Contents& info) const {
+        stats->bytes = bytes;
+        stats->records = info.num_records();
+        stats->fields = stats->records * info.num_fields();
+    }
+
+public:
+    void parse_buffer(const char* ptr, size_t n, Contents& info) const {
+        BufferInput input(ptr, ptr + n);
+        parse_loop(input, info);
+    }
+
+private:
+    struct Chunk {
+        const char* start = NULL;
+        const char* end = NULL;
+        size_t first_line = 0;
+
+        Contents contents;
+        std::vector<size_t> resolved_at;
+        RecordIndex index;
+        ParseStats stats;
+
+        bool failed = false;
+        size_t failed_line = 0;
+        std::string error;
+    };
+
+    // Appends the contents of a field from a chunk onto the final field,
+    // possibly converting from the source type 'T' to the destination 'U'.
+    template<typename T, Type tt, typename U = T, Type ut = tt>
+    static void append_field(Field* source, Field* destination) {
+        auto dptr = static_cast<TypedField<U, ut>*>(destination);
+        if (!source->filled()) {
+            for (size_t i = 0, n = source->size(); i < n; ++i) {
+                dptr->push_back(U());
+            }
+            return;
+        }
+
+        auto mptr = dynamic_cast<MaskedField<T, tt>*>(source);
+        if (mptr) {
+            if constexpr(std::is_same<T, U>::value && tt == ut) {
+                auto dmask = dynamic_cast<MaskedField<T, tt>*>(destination);
+                if (dmask) {
+                    dmask->append(*mptr);
+                    return;
+                }
+            }
+
+            for (size_t i = 0, n = mptr->size(); i < n; ++i) {
+                if (mptr->is_missing(i)) {
+                    dptr->add_missing();
+                } else {
+                    dptr->push_back(U(mptr->get(i)));
+                }
+            }
+            return;
+        }
+
+        auto sptr = static_cast<FilledField<T, tt>*>(source);
+        auto mIt = sptr->missing.begin(), mEnd = sptr->missing.end();
+        for (size_t i = 0, n = sptr->values.size(); i < n; ++i) {
+            if (mIt != mEnd && *mIt == i) {
+                dptr->add_missing();
+                ++mIt;
+            } else {
+                dptr->push_back(U(std::move(sptr->values[i])));
+            }
+        }
+    }
+
+    static void append_strings(Field* source, Field* destination) {
+        auto sview = dynamic_cast<StringViewField*>(source);
+        if (sview) {
+            auto dview = dynamic_cast<StringViewField*>(destination);
+            if (dview) {
+                dview->append(*sview);
+                return;
+            }
+
+            auto dptr = static_cast<StringField*>(destination);
+            auto mIt = sview->missing.begin(), mEnd = sview->missing.end();
+            for (size_t i = 0, n = sview->size(); i < n; ++i) {
+                if (mIt != mEnd && *mIt == i) {
+                    dptr->add_missing();
+                    ++mIt;
+                } else {
+                    dptr->push_back_view(sview->values[i], false);
+                }
+            }
+            return;
+        }
+
+        auto sarena = dynamic_cast<ArenaStringField*>(source);
+        if (!sarena) {
+            append_field<std::string, STRING>(source, destination);
+            return;
+        }
+
+        auto darena = dynamic_cast<ArenaStringField*>(destination);
+        if (darena) {
+            darena->append(*sarena);
+            return;
+        }
+
+        auto dptr = static_cast<StringField*>(destination);
+        auto mIt = sarena->missing.begin(), mEnd = sarena->missing.end();
+        for (size_t i = 0, n = sarena->size(); i < n; ++i) {
+            if (mIt != mEnd && *mIt == i) {
+                dptr->add_missing();
+                ++mIt;
+            } else {
+                dptr->push_back(std::string(sarena->get(i)));
+            }
+        }
+    }
+
+    static bool numeric_types(Type left, Type right) {
+        return (left == INTEGER || left == NUMBER) && (right == INTEGER || right == NUMBER);
+    }
+
+    void merge_chunks(std::vector<Chunk>& chunks, Contents& info, int nthreads) const {
+        size_t ncols = info.names.size();
+
+        // Finding the earliest error, either from parsing a chunk or from a
+        // type mismatch between the chunk and its predecessors.
+        std::vector<Type> types(ncols);
+        for (size_t c = 0; c < ncols; ++c) {
+            types[c] = info.fields[c]->type();
+        }
+
+        for (const auto& chunk : chunks) {
+            if (chunk.start == chunk.end) {
+                continue;
+            }
+
+            bool failed = chunk.failed;
+            size_t first_line = chunk.failed_line;
+            const std::string* first_error = &chunk.error;
+            static const std::string mismatch = "previous and current types do not match up";
+
+            for (size_t c = 0; c < ncols; ++c) {
+                auto observed = chunk.contents.fields[c]->type();
+                if (observed == UNKNOWN) {
+                    continue;
+                }
+                if (types[c] == UNKNOWN) {
+                    types[c] = observed;
+                } else if (detect_integers && numeric_types(types[c], observed)) {
+                    types[c] = (types[c] == INTEGER ? observed : NUMBER); // i.e., promoting to NUMBER if either is NUMBER.
+                } else if (types[c] != observed && (!failed || chunk.resolved_at[c] < first_line)) {
+                    failed = true;
+                    first_line = chunk.resolved_at[c];
+                    first_error = &mismatch;
+                }
+            }
+
+            if (failed) {
+                throw std::runtime_error(*first_error);
+            }
+        }
+
+        // Columns are independent so they can be merged in parallel.
+        parallelize(ncols, nthreads, [&](size_t c) -> void {
+            for (auto& chunk : chunks) {
+                if (chunk.start == chunk.end) {
+                    continue;
+                }
+
+                auto source = chunk.contents.fields[c].get();
+                auto observed = source->type();
+                if (observed == UNKNOWN) {
+                    auto destination = info.fields[c].get();
+                    for (size_t i = 0, n = source->size(); i < n; ++i) {
+                        destination->add_missing();
+                    }
+                    continue;
+                }
+
+                // Integers are converted if earlier chunks already contained non-integers.
+                if (observed == INTEGER && info.fields[c]->type() == NUMBER) {
+                    append_field<int64_t, INTEGER, double, NUMBER>(source, info.fields[c].get());
+                    continue;
+                }
+
+                auto destination = check_column_type(info, observed, c, chunk.resolved_at[c]);
+                switch (observed) {
+                    case STRING:
+                        append_strings(source, destination);
+                        break;
+                    case NUMBER:
+                        append_field<double, NUMBER>(source, destination);
+                        break;
+                    case BOOLEAN:
+                        append_field<bool, BOOLEAN>(source, destination);
+                        break;
+                    case COMPLEX:
+                        append_field<std::complex<double>, COMPLEX>(source, destination);
+                        break;
+                    case INTEGER:
+                        append_field<int64_t, INTEGER>(source, destination);
+                        break;
+                    default:
+                        throw std::runtime_error("unrecognized type during chunk merging");
+                }
+            }
+        });
     }
 
 public:
-    template<class Reader>
-    void parse(Reader& reader, Contents& info, bool parallel) const {
-        std::unique_ptr<byteme::BufferedReader<char> > pb;
-        if (parallel) {
-            pb.reset(new byteme::SerialBufferedReader<char, byteme::Reader*>(&reader, 65536));
+    // Each chunk is parsed into its own fields, created by 'chunk_creator';
+    // these should be either dummies or one of the built-in field classes,
+    // so that they can be merged into the final fields.
+    void parse_chunked(const char* ptr, size_t n, Contents& info, int nthreads, const FieldCreator* chunk_creator) const {
+        const char* end = ptr + n;
+        const char* header_end = (n ? find_record_end(ptr, end) : end);
+        if (nthreads <= 1 || header_end == end || *ptr == '\n') {
+            parse_buffer(ptr, n, info);
+            return;
+        }
+
+        ++header_end;
+        {
+            BufferInput input(ptr, header_end);
+            parse_header(input, info);
+        }
+        if (record_index) {
+            start_index(header_end - ptr);
+        }
+        if (split_index && split_index->size != n) {
+            throw std::runtime_error("record index does not match the size of the file");
+        }
+
+        // Restricting the records to the requested range before chunking.
+        size_t skipped = 0;
+        if (skip_records) {
+            if (split_index && skip_records < split_index->num_records) {
+                // Jumping to the closest preceding sampled record.
+                header_end = indexed_record(ptr, skip_records / split_index->interval);
+                size_t remainder = skip_records % split_index->interval;
+                if (remainder) {
+                    header_end = advance_records(header_end, end, remainder, skipped);
+                }
+                skipped = skip_records;
+            } else {
+                header_end = advance_records(header_end, end, skip_records, skipped);
+            }
+        }
+        if (max_records == 0) {
+            if (stats) {
+                finish_stats(header_end - ptr, info);
+            }
+            return;
+        } else if (max_records != std::numeric_limits<size_t>::max()) {
+            size_t found;
+            end = advance_records(header_end, end, max_records, found);
+        }
+        if (header_end == end) {
+            if (record_index) {
+                finish_index(n, 0, info);
+            }
+            if (stats) {
+                finish_stats(end - ptr, info);
+            }
+            return;
+        }
+
+        size_t nchunks = nthreads;
+        std::vector<Chunk> chunks(nchunks);
+        chunks.front().start = header_end;
+        chunks.front().first_line = 1 + skipped;
+        chunks.back().end = end;
+
+        if (split_index) {
+            // Splitting at the sampled records, which are known to lie outside of any strings;
+            // this also gives us the starting line of each chunk without any counting.
+            size_t nsampled = split_index->offsets.size();
+            for (size_t k = 1; k < nchunks; ++k) {
+                size_t i = nsampled * k / nchunks;
+                const char* boundary = end;
+                size_t first_line = 0;
+                if (i < nsampled) {
+                    boundary = indexed_record(ptr, i);
+                    first_line = 1 + i * split_index->interval;
+                }
+                if (boundary < header_end) {
+                    boundary = header_end;
+                    first_line = 1 + skipped;
+                } else if (boundary > end) {
+                    boundary = end;
+                }
+                boundary = std::max(boundary, chunks[k - 1].start);
+                chunks[k - 1].end = boundary;
+                chunks[k].start = boundary;
+                chunks[k].first_line = first_line;
+            }
         } else {
-            pb.reset(new byteme::ParallelBufferedReader<char, byteme::Reader*>(&reader, 65536));
+            split_chunks(end, chunks, nthreads);
+        }
+
+        // Progress is accumulated across all chunks, so the reported number of bytes includes those in the skipped records.
+        std::unique_ptr<internals::ProgressTracker> tracker;
+        if (progress) {
+            tracker.reset(new internals::ProgressTracker(*progress, header_end - ptr));
         }
-        parse_loop(*pb, info);
+
+        size_t ncols = info.names.size();
+        parallelize(nchunks, nthreads, [&](size_t k) -> void {
+            auto& chunk = chunks[k];
+            if (chunk.start == chunk.end) {
+                return;
+            }
+
+            Parser local(*this);
+            local.creator = chunk_creator;
+            chunk.resolved_at.resize(ncols);
+            local.resolved_at = &(chunk.resolved_at);
+            local.stats = nullptr; // counts are collected in each chunk and added later.
+            if (record_index) {
+                chunk.index.interval = record_index->interval;
+                local.record_index = &(chunk.index);
+            }
+
+            chunk.contents.names = info.names;
+            chunk.contents.fields.resize(ncols);
+            for (auto& f : chunk.contents.fields) {
+                f.reset(new UnknownField);
+            }
+
+            BufferInput input(chunk.start, chunk.end);
+            size_t line = chunk.first_line;
+            try {
+                ContentsStore store(local, chunk.contents);
+                if (tracker) {
+                    ProgressStore<ContentsStore, BufferInput> tracked(store, input, *tracker, progress_bytes, progress_records);
+                    local.parse_chunk(input, tracked, line, stats ? &(chunk.stats) : NULL);
+                } else {
+                    local.parse_chunk(input, store, line, stats ? &(chunk.stats) : NULL);
+                }
+            } catch (std::exception& e) {
+                chunk.failed = true;
+                chunk.failed_line = line;
+                chunk.error = e.what();
+            }
+        });
+
+        if (tracker && tracker->was_cancelled()) {
+            clear_contents(info);
+            throw ReadCancelled();
+        }
+
+        merge_chunks(chunks, info, nthreads);
+
+        // Each chunk's offsets are relative to its own start. The offset of
+        // each chunk's first record is reported by the preceding chunk.
+        if (record_index) {
+            for (const auto& chunk : chunks) {
+                for (auto o : chunk.index.offsets) {
+                    record_index->offsets.push_back(o + (chunk.start - ptr));
+                }
+            }
+            finish_index(n, info.num_records(), info);
+        }
+
+        if (stats) {
+            for (const auto& chunk : chunks) {
+                for (size_t t = 0; t < stats->values.size(); ++t) {
+                    stats->values[t] += chunk.stats.values[t];
+                }
+                stats->missing += chunk.stats.missing;
+            }
+            finish_stats(end - ptr, info);
+        }
+    }
+
+private:
+    // Splitting the records into chunks. We use the parity of the number of
+    // quotes to determine whether each tentative split point lies inside a
+    // string, and then we move forward to the next record.
+    static void split_chunks(const char* end, std::vector<Chunk>& chunks, int nthreads) {
+        size_t nchunks = chunks.size();
+        const char* header_end = chunks.front().start;
+        size_t remaining = end - header_end;
+        std::vector<const char*> tentative(nchunks + 1);
+        for (size_t k = 0; k <= nchunks; ++k) {
+            tentative[k] = header_end + static_cast<size_t>(static_cast<double>(remaining) * k / nchunks);
+        }
+        tentative[nchunks] = end;
+
+        std::vector<size_t> nquotes(nchunks);
+        parallelize(nchunks, nthreads, [&](size_t k) -> void {
+            nquotes[k] = count_quotes(tentative[k], tentative[k + 1]);
+        });
+
+        bool in_quotes = false;
+        for (size_t k = 1; k < nchunks; ++k) {
+            in_quotes = (in_quotes != (nquotes[k - 1] % 2 == 1));
+            const char* boundary = find_record_end(tentative[k], end, in_quotes);
+            if (boundary != end) {
+                ++boundary;
+            }
+            boundary = std::max(boundary, chunks[k - 1].start);
+            chunks[k - 1].end = boundary;
+            chunks[k].start = boundary;
+        }
+
+        // Figuring out the starting line of each chunk, for error messages.
+        std::vector<size_t> nrecords(nchunks);
+        parallelize(nchunks, nthreads, [&](size_t k) -> void {
+            nrecords[k] = count_records(chunks[k].start, chunks[k].end);
+        });
+        for (size_t k = 1; k < nchunks; ++k) {
+            chunks[k].first_line = chunks[k - 1].first_line + nrecords[k - 1];
+        }
+    }
+
+    // Returns the start of the 'i'-th sampled record in 'split_index', after
+    // checking that it follows a newline (as a cheap sanity check).
+    const char* indexed_record(const char* ptr, size_t i) const {
+        auto offset = split_index->offsets[i];
+        if (offset == 0 || offset > split_index->size || ptr[offset - 1] != '\n') {
+            throw std::runtime_error("record index does not match the contents of the file");
+        }
+        return ptr + offset;
+    }
+
+public:
+    // 'input' should be a byteme::BufferedReader, see with_buffered_input().
+    template<class Input>
+    void parse(Input& input, Contents& info) const {
+        parse_loop(input, info);
     }
 
     const FieldCreator* creator;
 
     bool check_store = false;
+    bool detect_integers = false;
+    ValidationLevel dummy_validation = ValidationLevel::FULL;
+    size_t skip_records = 0;
+    size_t max_records = std::numeric_limits<size_t>::max();
     std::unordered_set<std::string> to_store_by_name;
     std::unordered_set<size_t> to_store_by_index;
+
+    // Records the line at which each field's type was resolved, if not NULL.
+    std::vector<size_t>* resolved_at = nullptr;
+
+    // Receives the offsets of the records, if not NULL.
+    RecordIndex* record_index = nullptr;
+
+    // Used to split the records into chunks in parse_chunked(), if not NULL.
+    const RecordIndex* split_index = nullptr;
+
+    // Receives the counts of the parsed records and values, if not NULL.
+    ParseStats* stats = nullptr;
+
+    // Called with the progress of the parse, if not NULL.
+    const std::function<bool(const ReadProgress&)>* progress = nullptr;
+    uint64_t progress_bytes = 0;
+    uint64_t progress_records = 0;
 };
 /**
  * @endcond
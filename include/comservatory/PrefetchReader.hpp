@@ -0,0 +1,242 @@
+#ifndef COMSERVATORY_PREFETCHREADER_HPP
+#define COMSERVATORY_PREFETCHREADER_HPP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <algorithm>
+#include <stdexcept>
+#include <memory>
+#include <chrono>
+
+#include "byteme/byteme.hpp"
+
+#include "ParseStats.hpp"
+
+/**
+ * @file PrefetchReader.hpp
+ *
+ * @brief Defines the `PrefetchReader` class for reading ahead in a separate thread.
+ */
+
+namespace comservatory {
+
+/**
+ * @brief Read ahead from another reader in a separate thread.
+ *
+ * A worker thread fills a ring of buffers from the underlying reader, while the caller consumes the buffers that have already been filled.
+ * This allows I/O or decompression to overlap with parsing.
+ * Unlike `byteme::ParallelBufferedReader`, which only reads one buffer ahead, the number of prefetched buffers can be increased to smooth out variability in the speed of the underlying reader.
+ */
+class PrefetchReader : public byteme::Reader {
+public:
+    /**
+     * @param source Pointer to the underlying reader.
+     * This should outlive the `PrefetchReader`.
+     * @param buffer_size Size of each buffer.
+     * @param depth Number of buffers that can be filled ahead of the one being consumed by the caller.
+     * For example, a value of 2 corresponds to triple buffering.
+     */
+    PrefetchReader(byteme::Reader* source, size_t buffer_size, size_t depth) :
+        source(source),
+        buffers(std::max(depth, static_cast<size_t>(1)) + 1, std::vector<unsigned char>(std::max(buffer_size, static_cast<size_t>(1)))),
+        available(buffers.size())
+    {
+        worker = std::thread([&]() -> void { fill(); });
+    }
+
+    /**
+     * Stops the worker thread.
+     */
+    ~PrefetchReader() {
+        {
+            std::lock_guard<std::mutex> lck(mut);
+            stopped = true;
+        }
+        cv.notify_all();
+        worker.join();
+    }
+
+    /**
+     * @cond
+     */
+    PrefetchReader(const PrefetchReader&) = delete;
+    PrefetchReader& operator=(const PrefetchReader&) = delete;
+    /**
+     * @endcond
+     */
+
+public:
+    /**
+     * @param buffer Pointer to an array of length `n`, to store the read bytes.
+     * @param n Maximum number of bytes to read.
+     * @return Number of bytes read into `buffer`, which is only less than `n` at the end of the stream.
+     * Any error in the underlying reader is rethrown here.
+     */
+    size_t read(unsigned char* buffer, size_t n) {
+        size_t filled = 0;
+        while (filled < n) {
+            if (!acquired || position == available[consumer]) {
+                if (!next_buffer()) {
+                    break;
+                }
+            }
+
+            const auto& current = buffers[consumer];
+            size_t copied = std::min(available[consumer] - position, n - filled);
+            std::copy_n(current.data() + position, copied, buffer + filled);
+            filled += copied;
+            position += copied;
+        }
+        return filled;
+    }
+
+    /**
+     * @return Peak number of bytes that were read ahead of the caller, i.e., filled but not yet consumed.
+     */
+    size_t peak_buffered() {
+        std::lock_guard<std::mutex> lck(mut);
+        return peak;
+    }
+
+private:
+    // Releases the current buffer to the worker and waits for the next one.
+    // Returns false at the end of the stream.
+    bool next_buffer() {
+        std::unique_lock<std::mutex> lck(mut);
+        if (acquired) {
+            acquired = false;
+            --ready;
+            buffered -= available[consumer];
+            consumer = (consumer + 1) % buffers.size();
+            position = 0;
+            cv.notify_all();
+        }
+
+        cv.wait(lck, [&]() -> bool { return ready > 0 || finished; });
+        if (ready == 0) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+            return false;
+        }
+
+        acquired = true;
+        return true;
+    }
+
+    void fill() {
+        size_t producer = 0;
+        while (1) {
+            {
+                std::unique_lock<std::mutex> lck(mut);
+                cv.wait(lck, [&]() -> bool { return ready < buffers.size() || stopped; });
+                if (stopped) {
+                    return;
+                }
+            }
+
+            // The slot is not visible to the consumer until 'ready' is
+            // incremented, so it can be filled without holding the lock.
+            size_t got = 0;
+            std::exception_ptr err;
+            try {
+                got = source->read(buffers[producer].data(), buffers[producer].size());
+            } catch (...) {
+                err = std::current_exception();
+            }
+
+            {
+                std::lock_guard<std::mutex> lck(mut);
+                if (err) {
+                    error = err;
+                    finished = true;
+                } else if (got == 0) {
+                    finished = true;
+                } else {
+                    available[producer] = got;
+                    ++ready;
+                    buffered += got;
+                    peak = std::max(peak, buffered);
+                }
+            }
+            cv.notify_all();
+
+            if (got == 0) {
+                return;
+            }
+            producer = (producer + 1) % buffers.size();
+        }
+    }
+
+    byteme::Reader* source;
+    std::vector<std::vector<unsigned char> > buffers;
+    std::vector<size_t> available;
+
+    std::mutex mut;
+    std::condition_variable cv;
+    size_t ready = 0;
+    size_t buffered = 0, peak = 0;
+    bool finished = false, stopped = false;
+    std::exception_ptr error;
+
+    size_t consumer = 0, position = 0;
+    bool acquired = false;
+
+    std::thread worker;
+};
+
+/**
+ * @cond
+ */
+namespace internals {
+
+// Calls 'fun' with a buffered input for 'reader'. If 'parallel = true',
+// reading is performed in a separate thread, either with byteme's double
+// buffering or with a deeper ring of prefetched buffers. If 'stats' is not
+// NULL, the time spent waiting on the reader is also recorded; this always
+// uses a PrefetchReader for parallel reads so that the wait can be measured
+// from the caller's side.
+template<class Function>
+void with_buffered_input(byteme::Reader* reader, bool parallel, size_t buffer_size, size_t prefetch_depth, ParseStats* stats, Function fun) {
+    if (stats) {
+        auto start = std::chrono::steady_clock::now();
+        std::unique_ptr<PrefetchReader> prefetch;
+        if (parallel) {
+            prefetch.reset(new PrefetchReader(reader, buffer_size, prefetch_depth));
+            reader = prefetch.get();
+        }
+
+        TimedReader timed(reader);
+        {
+            byteme::SerialBufferedReader<char, byteme::Reader*> input(&timed, buffer_size);
+            fun(input);
+        }
+
+        stats->read_time += timed.elapsed;
+        stats->parse_time += std::max(seconds_since(start) - timed.elapsed, 0.0);
+        uint64_t buffered = buffer_size + (prefetch ? prefetch->peak_buffered() : 0);
+        stats->peak_buffered = std::max(stats->peak_buffered, buffered);
+    } else if (!parallel) {
+        byteme::SerialBufferedReader<char, byteme::Reader*> input(reader, buffer_size);
+        fun(input);
+    } else if (prefetch_depth <= 1) {
+        byteme::ParallelBufferedReader<char, byteme::Reader*> input(reader, buffer_size);
+        fun(input);
+    } else {
+        PrefetchReader prefetch(reader, buffer_size, prefetch_depth);
+        byteme::SerialBufferedReader<char, byteme::Reader*> input(&prefetch, buffer_size);
+        fun(input);
+    }
+}
+
+}
+/**
+ * @endcond
+ */
+
+}
+
+#endif
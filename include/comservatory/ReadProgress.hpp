@@ -0,0 +1,94 @@
+#ifndef COMSERVATORY_READPROGRESS_HPP
+#define COMSERVATORY_READPROGRESS_HPP
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+
+/**
+ * @file ReadProgress.hpp
+ *
+ * @brief Defines the `ReadProgress` class for monitoring and cancelling reads.
+ */
+
+namespace comservatory {
+
+/**
+ * @brief Progress of a read, as reported to `ReadOptions::progress`.
+ */
+struct ReadProgress {
+    /**
+     * Number of bytes of input that have been processed, including the header.
+     */
+    uint64_t bytes = 0;
+
+    /**
+     * Number of records that have been parsed, excluding the header and any skipped records.
+     */
+    uint64_t records = 0;
+};
+
+/**
+ * @brief Error that is thrown when a read is cancelled by `ReadOptions::progress`.
+ *
+ * This allows callers to distinguish a cancelled read from an invalid file.
+ */
+class ReadCancelled : public std::runtime_error {
+public:
+    /**
+     * @cond
+     */
+    ReadCancelled() : std::runtime_error("read was cancelled") {}
+    /**
+     * @endcond
+     */
+};
+
+/**
+ * @cond
+ */
+namespace internals {
+
+// Accumulates the progress from one or more parsing threads, calling the
+// user's callback once enough progress has been made.
+class ProgressTracker {
+public:
+    ProgressTracker(const std::function<bool(const ReadProgress&)>& fun, uint64_t start) : fun(fun) {
+        current.bytes = start;
+    }
+
+    // Returns false if the read was cancelled, either now or by another thread.
+    bool report(uint64_t bytes, uint64_t records) {
+        std::lock_guard<std::mutex> lck(mut);
+        if (cancelled) {
+            return false;
+        }
+
+        current.bytes += bytes;
+        current.records += records;
+        if (!fun(current)) {
+            cancelled = true;
+        }
+        return !cancelled;
+    }
+
+    bool was_cancelled() const {
+        return cancelled;
+    }
+
+private:
+    const std::function<bool(const ReadProgress&)>& fun;
+    std::mutex mut;
+    ReadProgress current;
+    bool cancelled = false;
+};
+
+}
+/**
+ * @endcond
+ */
+
+}
+
+#endif
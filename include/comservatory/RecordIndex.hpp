@@ -0,0 +1,224 @@
+#ifndef COMSERVATORY_RECORDINDEX_HPP
+#define COMSERVATORY_RECORDINDEX_HPP
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <algorithm>
+
+#include "Type.hpp"
+
+/**
+ * @file RecordIndex.hpp
+ *
+ * @brief Defines the `RecordIndex` class for random access to records.
+ */
+
+namespace comservatory {
+
+/**
+ * @brief Index of the byte offsets of records in a CSV file.
+ *
+ * The index contains the offset of the start of every `interval`-th record, counting from the first record after the header.
+ * As each record starts outside of any quoted string, a reader can start parsing directly from any of these offsets,
+ * e.g., to jump to a particular record or to split the file across multiple threads.
+ *
+ * Offsets refer to the decompressed contents of the file, so they can only be used to seek directly into uncompressed files.
+ */
+struct RecordIndex {
+    /**
+     * @param interval Interval between sampled records.
+     */
+    RecordIndex(size_t interval = 1024) : interval(interval) {}
+
+    /**
+     * Interval between sampled records.
+     * This should be positive.
+     */
+    size_t interval;
+
+    /**
+     * Byte offset of the start of every `interval`-th record, i.e., the `i`-th entry contains the offset of record `i * interval`,
+     * where record 0 is the first record after the header.
+     */
+    std::vector<uint64_t> offsets;
+
+    /**
+     * Total number of records in the file.
+     */
+    uint64_t num_records = 0;
+
+    /**
+     * Total size of the file in bytes.
+     * This can be used to check that the index is consistent with the file.
+     */
+    uint64_t size = 0;
+
+    /**
+     * Names of the fields in the CSV file.
+     */
+    std::vector<std::string> names;
+
+    /**
+     * Type of each field in the CSV file, as determined from all records.
+     * This is of length equal to `names`, and is used by `read_rows()` to create the fields before parsing a subset of records.
+     */
+    std::vector<Type> types;
+
+    /**
+     * @param record Index of the record of interest, where record 0 is the first record after the header.
+     * This should be less than `num_records`.
+     * @param[out] skip Number of records to skip after the returned offset, to reach `record`.
+     * @return Offset of the closest sampled record that precedes (or is equal to) `record`.
+     */
+    uint64_t locate(size_t record, size_t& skip) const {
+        if (record >= num_records) {
+            throw std::runtime_error("record " + std::to_string(record) + " is out of range");
+        }
+        size_t i = std::min(record / interval, offsets.size() - 1);
+        skip = record - i * interval;
+        return offsets[i];
+    }
+};
+
+/**
+ * @cond
+ */
+namespace internals {
+
+inline const char* record_index_magic() {
+    return "CSVRIDX1";
+}
+
+inline void write_uint64(std::FILE* handle, uint64_t value) {
+    unsigned char buffer[8];
+    for (int i = 0; i < 8; ++i) {
+        buffer[i] = (value >> (8 * i)) & 0xff;
+    }
+    std::fwrite(buffer, 1, 8, handle);
+}
+
+inline uint64_t read_uint64(std::FILE* handle, const char* path) {
+    unsigned char buffer[8];
+    if (std::fread(buffer, 1, 8, handle) != 8) {
+        std::fclose(handle);
+        throw std::runtime_error("truncated record index at '" + std::string(path) + "'");
+    }
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value |= static_cast<uint64_t>(buffer[i]) << (8 * i);
+    }
+    return value;
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @param index Index of the records in a CSV file, typically filled by `read()` via `ReadOptions::record_index`.
+ * @param path Path to the sidecar file in which to save the index.
+ *
+ * The index is saved in a compact binary format with little-endian 64-bit integers, which can be loaded with `load_record_index()`.
+ */
+inline void save_record_index(const RecordIndex& index, const char* path) {
+    std::FILE* handle = std::fopen(path, "wb");
+    if (handle == NULL) {
+        throw std::runtime_error("failed to open record index at '" + std::string(path) + "'");
+    }
+
+    std::fwrite(internals::record_index_magic(), 1, 8, handle);
+    internals::write_uint64(handle, index.interval);
+    internals::write_uint64(handle, index.num_records);
+    internals::write_uint64(handle, index.size);
+    internals::write_uint64(handle, index.offsets.size());
+    for (auto o : index.offsets) {
+        internals::write_uint64(handle, o);
+    }
+
+    internals::write_uint64(handle, index.names.size());
+    for (size_t c = 0, nfields = index.names.size(); c < nfields; ++c) {
+        internals::write_uint64(handle, index.types[c]);
+        const auto& name = index.names[c];
+        internals::write_uint64(handle, name.size());
+        std::fwrite(name.data(), 1, name.size(), handle);
+    }
+
+    bool failed = std::ferror(handle);
+    if (std::fclose(handle) != 0 || failed) {
+        throw std::runtime_error("failed to write record index at '" + std::string(path) + "'");
+    }
+}
+
+/**
+ * @param index Index of the records in a CSV file.
+ * @param path Path to the sidecar file in which to save the index.
+ */
+inline void save_record_index(const RecordIndex& index, const std::string& path) {
+    save_record_index(index, path.c_str());
+}
+
+/**
+ * @param path Path to a sidecar file created by `save_record_index()`.
+ * @return The index of the records in the CSV file.
+ */
+inline RecordIndex load_record_index(const char* path) {
+    std::FILE* handle = std::fopen(path, "rb");
+    if (handle == NULL) {
+        throw std::runtime_error("failed to open record index at '" + std::string(path) + "'");
+    }
+
+    char magic[8];
+    if (std::fread(magic, 1, 8, handle) != 8 || std::string(magic, 8) != internals::record_index_magic()) {
+        std::fclose(handle);
+        throw std::runtime_error("unrecognized record index format at '" + std::string(path) + "'");
+    }
+
+    RecordIndex output(internals::read_uint64(handle, path));
+    output.num_records = internals::read_uint64(handle, path);
+    output.size = internals::read_uint64(handle, path);
+    uint64_t n = internals::read_uint64(handle, path);
+    if (output.interval == 0 || n > output.size + 1) {
+        std::fclose(handle);
+        throw std::runtime_error("invalid record index at '" + std::string(path) + "'");
+    }
+
+    output.offsets.reserve(n);
+    for (uint64_t i = 0; i < n; ++i) {
+        output.offsets.push_back(internals::read_uint64(handle, path));
+    }
+
+    uint64_t nfields = internals::read_uint64(handle, path);
+    for (uint64_t c = 0; c < nfields; ++c) {
+        uint64_t type = internals::read_uint64(handle, path);
+        if (type > INTEGER) {
+            std::fclose(handle);
+            throw std::runtime_error("invalid record index at '" + std::string(path) + "'");
+        }
+        output.types.push_back(static_cast<Type>(type));
+
+        std::string name(internals::read_uint64(handle, path), '\0');
+        if (std::fread(name.data(), 1, name.size(), handle) != name.size()) {
+            std::fclose(handle);
+            throw std::runtime_error("truncated record index at '" + std::string(path) + "'");
+        }
+        output.names.push_back(std::move(name));
+    }
+    std::fclose(handle);
+    return output;
+}
+
+/**
+ * @param path Path to a sidecar file created by `save_record_index()`.
+ * @return The index of the records in the CSV file.
+ */
+inline RecordIndex load_record_index(const std::string& path) {
+    return load_record_index(path.c_str());
+}
+
+}
+
+#endif
@@ -17,7 +17,8 @@ enum Type {
     NUMBER,
     COMPLEX,
     BOOLEAN,
-    UNKNOWN
+    UNKNOWN,
+    INTEGER
 };
 
 /**
@@ -36,6 +37,8 @@ inline std::string type_to_name (Type type) {
             return "COMPLEX";
         case UNKNOWN:
             return "UNKNOWN";
+        case INTEGER:
+            return "INTEGER";
         default:
             throw std::runtime_error("unrecognized type for name generation");
     }
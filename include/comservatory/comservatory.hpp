@@ -14,5 +14,17 @@
 namespace comservatory {}
 
 #include "read.hpp"
+#include "read_typed.hpp"
+#include "visit.hpp"
+#include "BatchReader.hpp"
+#include "RecordIndex.hpp"
+#include "GzipIndex.hpp"
+#include "read_rows.hpp"
+#include "ParallelGzipReader.hpp"
+#include "BlockedGzipWriter.hpp"
+#include "PrefetchReader.hpp"
+#include "ParseStats.hpp"
+#include "ReadProgress.hpp"
+#include "write.hpp"
 
 #endif
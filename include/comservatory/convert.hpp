@@ -2,10 +2,21 @@
 #define COMSERVATORY_CONVERT_HPP
 
 #include <string>
+#include <string_view>
 #include <cctype>
 #include <complex>
 #include <cmath>
 #include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <charconv>
+
+#include "input.hpp"
+#include "eisel_lemire.hpp"
 
 namespace comservatory {
 
@@ -15,18 +26,23 @@ inline std::string get_location(size_t column, size_t line) {
 
 // Assumes that 'input' is located on the opening double quote. On return,
 // 'input' is left on the next character _after_ the closing double quote.
-template<class Input>
-std::string to_string(Input& input, size_t column, size_t line) {
-    std::string output;
-
-    while (1) {
-        input.advance();
-        if (!input.valid()) {
-            throw std::runtime_error("truncated string in " + get_location(column, line));
-        }
+// The unescaped contents are appended to 'output', which may be any
+// container of characters that supports 'push_back()' and range 'insert()'.
+template<class Input, class Output>
+void to_string(Input& input, size_t column, size_t line, Output& output) {
+    if constexpr(std::is_same<Input, BufferInput>::value) {
+        // For contiguous inputs, we jump to the next quote and copy the
+        // entire run of preceding characters at once.
+        while (1) {
+            input.advance();
+            const char* run = input.current;
+            auto quote = static_cast<const char*>(std::memchr(run, '"', input.end - run));
+            if (quote == NULL) {
+                throw std::runtime_error("truncated string in " + get_location(column, line));
+            }
+            output.insert(output.end(), run, quote);
 
-        char next = input.get();
-        if (next == '"') {
+            input.current = quote;
             input.advance();
             if (!input.valid()) {
                 throw std::runtime_error("line " + std::to_string(line + 1) + " should be terminated with a newline");
@@ -35,13 +51,81 @@ std::string to_string(Input& input, size_t column, size_t line) {
             if (input.get() != '"') {
                 break;
             } else {
-                output += '"';
+                output.push_back('"');
+            }
+        }
+
+    } else {
+        // Otherwise, we stage characters in a local buffer and flush it in
+        // bulk, to avoid a capacity check on 'output' for every character.
+        constexpr size_t staging_size = 256;
+        char staging[staging_size];
+        size_t used = 0;
+
+        while (1) {
+            input.advance();
+            if (!input.valid()) {
+                throw std::runtime_error("truncated string in " + get_location(column, line));
+            }
+
+            char next = input.get();
+            if (next == '"') {
+                input.advance();
+                if (!input.valid()) {
+                    throw std::runtime_error("line " + std::to_string(line + 1) + " should be terminated with a newline");
+                }
+
+                if (input.get() != '"') {
+                    break;
+                }
+            }
+
+            staging[used] = next;
+            ++used;
+            if (used == staging_size) {
+                output.insert(output.end(), staging, staging + used);
+                used = 0;
             }
-        } else {
-            output += next;
         }
+
+        output.insert(output.end(), staging, staging + used);
+    }
+}
+
+// Same as to_string() for contiguous inputs, but returns a view into the
+// input if the string does not contain any escaped quotes. Otherwise, the
+// unescaped contents are stored in 'scratch' and 'escaped' is set to true.
+inline std::string_view to_string_view(BufferInput& input, size_t column, size_t line, std::string& scratch, bool& escaped) {
+    input.advance();
+    const char* run = input.current;
+    auto quote = static_cast<const char*>(std::memchr(run, '"', input.end - run));
+    if (quote == NULL) {
+        throw std::runtime_error("truncated string in " + get_location(column, line));
+    }
+
+    input.current = quote;
+    input.advance();
+    if (!input.valid()) {
+        throw std::runtime_error("line " + std::to_string(line + 1) + " should be terminated with a newline");
+    }
+
+    if (input.get() != '"') {
+        escaped = false;
+        return std::string_view(run, quote - run);
     }
 
+    // We're now on the second quote of an escaped pair, which to_string()
+    // can treat as if it were an opening quote.
+    escaped = true;
+    scratch.assign(run, quote + 1);
+    to_string(input, column, line, scratch);
+    return std::string_view(scratch);
+}
+
+template<class Input>
+std::string to_string(Input& input, size_t column, size_t line) {
+    std::string output;
+    to_string(input, column, line, output);
     return output;
 }
 
@@ -62,13 +146,166 @@ void expect_fixed(Input& input, const std::string& lower, const std::string& upp
     }
 }
 
+// Only the first 19 significant digits can be stored exactly in a 64-bit integer.
+static constexpr int max_exact_digits = 19;
+
+// Converts a decimal number into the nearest double. The number is defined as
+// 'mantissa * 10^total' if 'significant' is no greater than 'max_exact_digits',
+// otherwise it is defined as 'overflow * 10^total' where 'overflow' contains
+// all of the significant digits.
+inline double decimal_to_double(uint64_t mantissa, int significant, int64_t total, const std::string& overflow) {
+    if (significant == 0) {
+        return 0;
+    }
+
+    // Clinger's fast path: both the mantissa and power of 10 are exactly
+    // representable, so a single multiplication or division is correctly rounded.
+    static constexpr double exact_powers[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    if (significant <= max_exact_digits && mantissa <= (static_cast<uint64_t>(1) << 53) && total >= -22 && total <= 22) {
+        double value = mantissa;
+        if (total >= 0) {
+            return value * exact_powers[total];
+        } else {
+            return value / exact_powers[-total];
+        }
+    }
+
+    if (significant <= max_exact_digits) {
+        return eisel_lemire(mantissa, total);
+    }
+
+    // Otherwise, for very long significands, we fall back to a correctly
+    // rounded conversion of the digits in scientific notation; there is
+    // no decimal point, so this is independent of the locale.
+    std::string digits = overflow;
+    digits += 'e';
+    digits += std::to_string(total);
+
+    double value = 0;
+#ifdef __cpp_lib_to_chars
+    auto res = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+    if (res.ec == std::errc::result_out_of_range) {
+        value = (total > 0 ? std::numeric_limits<double>::infinity() : 0);
+    }
+#else
+    value = std::strtod(digits.c_str(), NULL);
+#endif
+    return value;
+}
+
+// Accumulates the digits of a decimal number into an integer significand and
+// a power-of-10 exponent, i.e., the value is 'significand * 10^scale'. If
+// there are too many digits to store exactly, all significant digits are kept
+// as a string instead.
+struct DecimalAccumulator {
+    // The string is owned by the caller so that the other members can be
+    // kept in registers during accumulation.
+    DecimalAccumulator(std::string& overflow) : overflow(&overflow) {}
+
+    uint64_t mantissa = 0;
+    int significant = 0;
+    int64_t scale = 0;
+    std::string* overflow;
+
+    void add_integer(unsigned int digit) {
+        if (significant < max_exact_digits) {
+            mantissa = mantissa * 10 + digit;
+            significant += (mantissa != 0); // leading zeros are not significant.
+        } else {
+            add_overflow(*overflow, mantissa, significant, digit);
+            ++significant;
+        }
+    }
+
+    void add_fraction(unsigned int digit) {
+        add_integer(digit);
+        --scale;
+    }
+
+    static void add_overflow(std::string& overflow, uint64_t mantissa, int significant, unsigned int digit) {
+        if (significant == max_exact_digits) {
+            overflow = std::to_string(mantissa);
+        }
+        overflow += static_cast<char>('0' + digit);
+    }
+
+    void add_eight(uint32_t digits, bool fraction) {
+        mantissa = mantissa * 100000000 + digits;
+        significant += 8;
+        if (fraction) {
+            scale -= 8;
+        }
+    }
+
+    bool can_add_eight() const {
+        return significant && significant + 8 <= max_exact_digits;
+    }
+
+    double finish(int64_t exponent) const {
+        return decimal_to_double(mantissa, significant, scale + exponent, *overflow);
+    }
+};
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define COMSERVATORY_SWAR_DIGITS 1
+
+// SWAR tricks for parsing 8 digits at once, see Lemire (2022), "Number Parsing at a Gigabyte per Second".
+inline bool is_eight_digits(uint64_t val) {
+    return (((val & 0xF0F0F0F0F0F0F0F0) | (((val + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) == 0x3333333333333333);
+}
+
+inline uint32_t parse_eight_digits(uint64_t val) {
+    const uint64_t mask = 0x000000FF000000FF;
+    const uint64_t mul1 = 0x000F424000000064; // 100 + (1000000ULL << 32)
+    const uint64_t mul2 = 0x0000271000000001; // 1 + (10000ULL << 32)
+    val -= 0x3030303030303030;
+    val = (val * 10) + (val >> 8);
+    val = (((val & mask) * mul1) + (((val >> 16) & mask) * mul2)) >> 32;
+    return static_cast<uint32_t>(val);
+}
+#endif
+
+// Consumes runs of 8 digits at a time from contiguous inputs.
+template<class Input>
+void consume_eight_digits(Input& input, DecimalAccumulator& acc, bool fraction) {
+#ifdef COMSERVATORY_SWAR_DIGITS
+    if constexpr(std::is_same<Input, BufferInput>::value) {
+        while (acc.can_add_eight() && input.end - input.current >= 8) {
+            uint64_t chunk;
+            std::memcpy(&chunk, input.current, 8);
+            if (!is_eight_digits(chunk)) {
+                break;
+            }
+            acc.add_eight(parse_eight_digits(chunk), fraction);
+            input.current += 8;
+        }
+    }
+#else
+    (void)input;
+    (void)acc;
+    (void)fraction;
+#endif
+}
+
+// Describes an integer-formatted number, i.e., without a fraction or exponent,
+// whose absolute value can be stored exactly in a 64-bit unsigned integer.
+struct IntegerCapture {
+    bool found = false;
+    uint64_t magnitude = 0;
+};
+
 // Assumes that 'input' is located on the first digit. On return, 'input' is
-// left on the first character _after_ the end of the number.
+// left on the first character _after_ the end of the number. If 'integer' is
+// not NULL, it is filled with the magnitude of integer-formatted numbers.
 template<class Input>
-double to_number(Input& input, size_t column, size_t line) {
-    double value = 0;
-    double fractional = 10;
-    double exponent = 0; 
+double to_number(Input& input, size_t column, size_t line, IntegerCapture* integer = NULL) {
+    std::string overflow;
+    DecimalAccumulator acc(overflow);
+    int integer_digits = 0;
+    int64_t exponent = 0; 
     bool negative_exponent = false;
 
     auto is_terminator = [](char v) -> bool {
@@ -80,14 +317,23 @@ double to_number(Input& input, size_t column, size_t line) {
 
     // We assume we're starting from a digit, after handling any preceding sign. 
     char lead = input.get();
-    value += lead - '0';
+    acc.add_integer(lead - '0');
     input.advance();
 
+    // Integer parts are usually short, so we only use SWAR for the fraction,
+    // where the extra check is more likely to pay off.
     while (1) {
         if (!input.valid()) {
             throw std::runtime_error("line " + std::to_string(line + 1) + " should be terminated with a newline");
         }
         char val = input.get();
+        unsigned int digit = static_cast<unsigned char>(val) - '0';
+        if (digit < 10) {
+            acc.add_integer(digit);
+            input.advance();
+            continue;
+        }
+
         if (val == '.') {
             in_fraction = true;
             break;
@@ -95,14 +341,16 @@ double to_number(Input& input, size_t column, size_t line) {
             in_exponent = true;
             break;
         } else if (is_terminator(val)) {
-            return value;
-        } else if (!std::isdigit(val)) {
+            if (integer && acc.significant <= max_exact_digits) {
+                integer->found = true;
+                integer->magnitude = acc.mantissa;
+            }
+            return acc.finish(0);
+        } else {
             throw std::runtime_error("invalid number containing '" + std::string(1, val) + "' at " + get_location(column, line));
         }
-        value *= 10;
-        value += val - '0';
-        input.advance();
     }
+    integer_digits = acc.significant;
 
     if (in_fraction) {
         input.advance();
@@ -114,30 +362,36 @@ double to_number(Input& input, size_t column, size_t line) {
         if (!std::isdigit(val)) {
             throw std::runtime_error("'.' must be followed by at least one digit at " + get_location(column, line));
         }
-        value += (val - '0') / fractional;
+        acc.add_fraction(val - '0');
 
         input.advance();
+        consume_eight_digits(input, acc, true);
         while (1) {
             if (!input.valid()) {
                 throw std::runtime_error("line " + std::to_string(line + 1) + " should be terminated with a newline");
             }
             char val = input.get();
+            unsigned int digit = static_cast<unsigned char>(val) - '0';
+            if (digit < 10) {
+                acc.add_fraction(digit);
+                input.advance();
+                continue;
+            }
+
             if (val == 'e' || val == 'E') {
                 in_exponent = true;
                 break;
             } else if (is_terminator(val)) {
-                return value;
-            } else if (!std::isdigit(val)) {
+                return acc.finish(0);
+            } else {
                 throw std::runtime_error("invalid fraction containing '" + std::string(1, val) + "' at " + get_location(column, line));
             }
-            fractional *= 10;
-            value += (val - '0') / fractional;
-            input.advance();
         } 
     }
 
     if (in_exponent) {
-        if (value < 1 || value >= 10) {
+        // Mantissa lies in [1, 10) if the integer part has exactly one significant digit.
+        if (integer_digits != 1) {
             throw std::runtime_error("absolute value of mantissa should be within [1, 10) at " + get_location(column, line));
         }
 
@@ -176,20 +430,323 @@ double to_number(Input& input, size_t column, size_t line) {
             } else if (!std::isdigit(val)) {
                 throw std::runtime_error("invalid exponent containing '" + std::string(1, val) + "' at " + get_location(column, line));
             }
-            exponent *= 10;
-            exponent += (val - '0');
+            if (exponent < 1000000000) { // saturating, as the result will be zero or infinite anyway.
+                exponent *= 10;
+                exponent += (val - '0');
+            }
             input.advance();
         } 
 
-        if (exponent) {
-            if (negative_exponent) {
-                exponent *= -1;
+        if (negative_exponent) {
+            exponent *= -1;
+        }
+    }
+
+    return acc.finish(exponent);
+}
+
+// Same as to_number(), but only checks the grammar of the number without
+// computing its value. If 'integer' is not NULL, it is still filled with the
+// magnitude of integer-formatted numbers, to determine the type.
+template<class Input>
+void skip_number(Input& input, size_t column, size_t line, IntegerCapture* integer = NULL) {
+    auto is_terminator = [](char v) -> bool {
+        return v == ',' || v == '\n' || v == '+' || v == '-' || v == 'i'; 
+    };
+
+    // Tracking the number of significant digits in the integer part, for
+    // the mantissa check in scientific notation.
+    uint64_t magnitude = 0;
+    int significant = 0;
+    auto add_digit = [&](unsigned int digit) -> void {
+        if (significant < max_exact_digits) {
+            magnitude = magnitude * 10 + digit;
+            significant += (magnitude != 0);
+        } else {
+            ++significant;
+        }
+    };
+
+    char lead = input.get();
+    add_digit(lead - '0');
+    input.advance();
+
+    bool in_fraction = false;
+    bool in_exponent = false;
+    while (1) {
+        if (!input.valid()) {
+            throw std::runtime_error("line " + std::to_string(line + 1) + " should be terminated with a newline");
+        }
+        char val = input.get();
+        unsigned int digit = static_cast<unsigned char>(val) - '0';
+        if (digit < 10) {
+            add_digit(digit);
+            input.advance();
+            continue;
+        }
+
+        if (val == '.') {
+            in_fraction = true;
+            break;
+        } else if (val == 'e' || val == 'E') {
+            in_exponent = true;
+            break;
+        } else if (is_terminator(val)) {
+            if (integer && significant <= max_exact_digits) {
+                integer->found = true;
+                integer->magnitude = magnitude;
+            }
+            return;
+        } else {
+            throw std::runtime_error("invalid number containing '" + std::string(1, val) + "' at " + get_location(column, line));
+        }
+    }
+
+    if (in_fraction) {
+        input.advance();
+        if (!input.valid()) {
+            throw std::runtime_error("line " + std::to_string(line + 1) + " should be terminated with a newline");
+        }
+        if (!std::isdigit(input.get())) {
+            throw std::runtime_error("'.' must be followed by at least one digit at " + get_location(column, line));
+        }
+
+        input.advance();
+        while (1) {
+            if (!input.valid()) {
+                throw std::runtime_error("line " + std::to_string(line + 1) + " should be terminated with a newline");
+            }
+            char val = input.get();
+            if (std::isdigit(val)) {
+                input.advance();
+                continue;
+            }
+
+            if (val == 'e' || val == 'E') {
+                in_exponent = true;
+                break;
+            } else if (is_terminator(val)) {
+                return;
+            } else {
+                throw std::runtime_error("invalid fraction containing '" + std::string(1, val) + "' at " + get_location(column, line));
             }
-            value *= std::pow(10.0, exponent);
         }
     }
 
-    return value;
+    if (in_exponent) {
+        if (significant != 1) {
+            throw std::runtime_error("absolute value of mantissa should be within [1, 10) at " + get_location(column, line));
+        }
+
+        input.advance();
+        if (!input.valid()) {
+            throw std::runtime_error("line " + std::to_string(line + 1) + " should be terminated with a newline");
+        }
+
+        char val = input.get();
+        if (!std::isdigit(val)) {
+            if (val != '-' && val != '+') {
+                throw std::runtime_error("'e/E' should be followed by a sign or digit in number at " + get_location(column, line));
+            }
+            input.advance();
+
+            if (!input.valid()) {
+                throw std::runtime_error("line " + std::to_string(line + 1) + " should be terminated with a newline");
+            }
+            if (!std::isdigit(input.get())) {
+                throw std::runtime_error("exponent sign must be followed by at least one digit in number at " + get_location(column, line));
+            }
+        }
+
+        input.advance();
+        while (1) {
+            if (!input.valid()) {
+                throw std::runtime_error("line " + std::to_string(line + 1) + " should be terminated with a newline");
+            }
+            char val = input.get();
+            if (is_terminator(val)) {
+                break;
+            } else if (!std::isdigit(val)) {
+                throw std::runtime_error("invalid exponent containing '" + std::string(1, val) + "' at " + get_location(column, line));
+            }
+            input.advance();
+        }
+    }
+}
+
+// Same as to_string(), but only checks the grammar of the string without
+// storing its contents.
+template<class Input>
+void skip_string(Input& input, size_t column, size_t line) {
+    if constexpr(std::is_same<Input, BufferInput>::value) {
+        while (1) {
+            input.advance();
+            const char* run = input.current;
+            auto quote = static_cast<const char*>(std::memchr(run, '"', input.end - run));
+            if (quote == NULL) {
+                throw std::runtime_error("truncated string in " + get_location(column, line));
+            }
+
+            input.current = quote;
+            input.advance();
+            if (!input.valid()) {
+                throw std::runtime_error("line " + std::to_string(line + 1) + " should be terminated with a newline");
+            }
+            if (input.get() != '"') {
+                break;
+            }
+        }
+
+    } else {
+        while (1) {
+            input.advance();
+            if (!input.valid()) {
+                throw std::runtime_error("truncated string in " + get_location(column, line));
+            }
+
+            if (input.get() == '"') {
+                input.advance();
+                if (!input.valid()) {
+                    throw std::runtime_error("line " + std::to_string(line + 1) + " should be terminated with a newline");
+                }
+                if (input.get() != '"') {
+                    break;
+                }
+            }
+        }
+    }
+}
+
+// Skips over a field, only checking that it is not empty and that any
+// string is properly terminated. On return, 'input' is left on the
+// delimiter after the field, or at the end of the input.
+template<class Input>
+void skip_field(Input& input, size_t column, size_t line) {
+    char first = input.get();
+    if (first == '"') {
+        skip_string(input, column, line);
+        return;
+    } else if (first == '\n') {
+        throw std::runtime_error(get_location(column, line) + " is empty");
+    } else if (first == ',') {
+        throw std::runtime_error("unknown type starting with ',' in " + get_location(column, line));
+    }
+
+    if constexpr(std::is_same<Input, BufferInput>::value) {
+        const char* current = input.current;
+        while (current < input.end && *current != ',' && *current != '\n') {
+            ++current;
+        }
+        input.current = current;
+    } else {
+        while (input.advance()) {
+            char next = input.get();
+            if (next == ',' || next == '\n') {
+                break;
+            }
+        }
+    }
+}
+
+// Converts an integer-formatted number into a signed 64-bit integer, if the
+// number was captured by to_number() and is within range.
+inline bool to_int64(const IntegerCapture& integer, bool negative, int64_t& output) {
+    if (!integer.found) {
+        return false;
+    }
+
+    constexpr uint64_t limit = std::numeric_limits<int64_t>::max();
+    if (!negative) {
+        if (integer.magnitude > limit) {
+            return false;
+        }
+        output = integer.magnitude;
+    } else {
+        if (integer.magnitude > limit + 1) {
+            return false;
+        }
+        output = (integer.magnitude ? -static_cast<int64_t>(integer.magnitude - 1) - 1 : 0);
+    }
+
+    return true;
+}
+
+// Assumes that 'input' is located on the character after the real part of a
+// complex number, i.e., the sign of the imaginary part. On return, 'input' is
+// left on the first character _after_ the trailing 'i'. If 'skip = true', only
+// the grammar is checked and zero is returned.
+template<class Input>
+double to_imaginary(Input& input, size_t column, size_t line, bool skip = false) {
+    char next = input.get();
+    bool negative = false;
+    if (next == '-') {
+        negative = true;
+    } else if (next != '+') {
+        throw std::runtime_error("incorrectly formatted number in " + get_location(column, line));
+    }
+
+    input.advance();
+    if (!input.valid()) {
+        throw std::runtime_error("truncated complex number in " + get_location(column, line));
+    } else if (!std::isdigit(input.get())) {
+        throw std::runtime_error("incorrectly formatted complex number in " + get_location(column, line));
+    }
+
+    double second = 0;
+    if (skip) {
+        skip_number(input, column, line);
+    } else {
+        second = to_number(input, column, line);
+    }
+    if (negative) {
+        second *= -1;
+    }
+    if (input.get() != 'i') { // no need to check validity, as to_number always leaves us on a valid position (or throws itself).
+        throw std::runtime_error("incorrectly formatted complex number in " + get_location(column, line));
+    }
+    input.advance(); // for consistency with the numbers, in the sense that we are always past the keyword regardless of whether we're a NUMBER or COMPLEX.
+
+    return second;
+}
+
+// Assumes that 'input' is located on the leading 'N'. Returns true if the
+// keyword is NA, otherwise false for NaN (or any of its capitalizations). On
+// return, 'input' is left on the first character _after_ the keyword.
+template<class Input>
+bool to_missing_or_nan(Input& input, size_t column, size_t line) {
+    // Some shenanigans required here to distinguish between
+    // NAN/NaN/etc. and NA, given that both are allowed.
+    input.advance();
+    if (!input.valid()) {
+        throw std::runtime_error("truncated keyword in " + get_location(column, line));
+    }
+
+    char second = input.get();
+    bool is_missing = true;
+    if (second == 'a') {
+        is_missing = false;
+    } else if (second != 'A') {
+        throw std::runtime_error("unknown keyword in " + get_location(column, line));
+    }
+
+    input.advance();
+    if (!input.valid()) {
+        if (is_missing) {
+            throw std::runtime_error("line " + std::to_string(line + 1) + " should terminate with a newline");
+        } else {
+            throw std::runtime_error("truncated keyword in " + get_location(column, line));
+        }
+    }
+
+    char next = input.get();
+    if (next == 'n' || next == 'N') {
+        input.advance(); // for consistency with the NA case, in the sense that we are always past the keyword regardless of whether the keyword is NaN or NA.
+        return false;
+    } else if (is_missing) {
+        return true;
+    } else {
+        throw std::runtime_error("unknown keyword in " + get_location(column, line));
+    }
 }
 
 }
@@ -0,0 +1,38 @@
+#ifndef COMSERVATORY_INPUT_HPP
+#define COMSERVATORY_INPUT_HPP
+
+#include <cstddef>
+
+namespace comservatory {
+
+// Input over a contiguous in-memory buffer, implementing the same methods as
+// byteme::BufferedReader. As the entire buffer is already available, each
+// method is a simple pointer operation without any refill logic.
+struct BufferInput {
+    BufferInput(const char* start, const char* end) : start(start), current(start), end(end) {}
+
+    bool valid() const {
+        return current < end;
+    }
+
+    char get() const {
+        return *current;
+    }
+
+    bool advance() {
+        ++current;
+        return current < end;
+    }
+
+    unsigned long long position() const {
+        return current - start;
+    }
+
+    const char* start;
+    const char* current;
+    const char* end;
+};
+
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef COMSERVATORY_PARALLELIZE_HPP
+#define COMSERVATORY_PARALLELIZE_HPP
+
+#include <vector>
+#include <thread>
+#include <string>
+#include <stdexcept>
+
+namespace comservatory {
+
+// Runs 'fun(i)' for each task 'i' in '[0, ntasks)' across up to 'nthreads'
+// threads. Tasks are assigned in contiguous blocks. If any task throws, the
+// error from the earliest failing thread is rethrown after all threads join.
+template<class Function>
+void parallelize(size_t ntasks, int nthreads, Function fun) {
+    if (nthreads <= 1 || ntasks <= 1) {
+        for (size_t i = 0; i < ntasks; ++i) {
+            fun(i);
+        }
+        return;
+    }
+
+    size_t nworkers = std::min(ntasks, static_cast<size_t>(nthreads));
+    size_t per_worker = ntasks / nworkers, remainder = ntasks % nworkers;
+
+    std::vector<std::thread> workers;
+    workers.reserve(nworkers);
+    std::vector<std::string> errors(nworkers);
+    std::vector<char> failed(nworkers);
+
+    size_t start = 0;
+    for (size_t w = 0; w < nworkers; ++w) {
+        size_t end = start + per_worker + (w < remainder);
+        workers.emplace_back([&](size_t w, size_t start, size_t end) -> void {
+            try {
+                for (size_t i = start; i < end; ++i) {
+                    fun(i);
+                }
+            } catch (std::exception& e) {
+                errors[w] = e.what();
+                failed[w] = true;
+            } catch (...) {
+                errors[w] = "unknown error in worker thread";
+                failed[w] = true;
+            }
+        }, w, start, end);
+        start = end;
+    }
+
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    for (size_t w = 0; w < nworkers; ++w) {
+        if (failed[w]) {
+            throw std::runtime_error(errors[w]);
+        }
+    }
+}
+
+}
+
+#endif
@@ -3,8 +3,21 @@
 
 #include <vector>
 #include <string>
+#include <algorithm>
+#include <type_traits>
+#include <memory>
+#include <limits>
+#include <chrono>
+#include <functional>
 #include "Creator.hpp"
 #include "Parser.hpp"
+#include "RecordIndex.hpp"
+#include "ParseStats.hpp"
+#include "ReadProgress.hpp"
+#include "GzipIndex.hpp"
+#include "ParallelGzipReader.hpp"
+#include "PrefetchReader.hpp"
+#include "MappedFile.hpp"
 #include "byteme/byteme.hpp"
 
 /**
@@ -21,9 +34,44 @@ namespace comservatory {
 struct ReadOptions {
     /**
      * Whether to parallelize reading and parsing in multi-threaded environments.
+     * If `true`, the input is read ahead in a separate thread so that I/O or decompression overlaps with parsing.
      */
     bool parallel = false;
 
+    /**
+     * Size of the buffer for reading the input, in bytes.
+     * Only used when streaming through a reader without contiguous storage.
+     */
+    size_t buffer_size = 65536;
+
+    /**
+     * Number of buffers to read ahead of the parser when `parallel = true`.
+     * A value of 1 corresponds to double buffering, 2 to triple buffering, and so on.
+     * Larger values can smooth out variability in the speed of the reader at the cost of `buffer_size` bytes of memory per buffer.
+     */
+    size_t prefetch_depth = 1;
+
+    /**
+     * Number of threads to use for parsing.
+     * If greater than 1, the entire input is loaded into memory and its records are split into chunks that are parsed in parallel.
+     * The results are identical to those from a serial parse, including the error messages for invalid files.
+     * If `creator` is set, its `FieldCreator::create()` method should be thread-safe.
+     */
+    int num_threads = 1;
+
+    /**
+     * Whether `read_file()` should memory-map uncompressed files instead of reading them through a buffer.
+     * This allows the entire file to be parsed as a single contiguous span without any copying.
+     * Only used if `COMSERVATORY_HAS_MMAP` is defined.
+     */
+    bool memory_map = false;
+
+    /**
+     * Whether to advise the kernel to use huge pages for the memory mapping.
+     * Only used if `memory_map = true`.
+     */
+    bool huge_pages = false;
+
     /**
      * Whether to only validate the CSV structure, not store any of the data in memory.
      * If `true`, all fields in the output `Contents` are represented by dummy placeholders,
@@ -31,6 +79,38 @@ struct ReadOptions {
      */
     bool validate_only = false;
 
+    /**
+     * Whether to store integer-formatted numbers as 64-bit integers.
+     * If `true`, fields containing only integers (and missing values) are reported as `INTEGER`,
+     * e.g., as `FilledIntegerField`s that can exactly represent values beyond 2^53.
+     * If a field later contains a decimal, scientific, non-finite or out-of-range number, it is promoted to `NUMBER` via `FieldCreator::promote()`.
+     * If `false`, all numbers are reported in `NUMBER` fields.
+     */
+    bool detect_integers = false;
+
+    /**
+     * Whether to store strings in `ArenaStringField`s instead of `FilledStringField`s.
+     * This reduces memory usage for fields with many short strings.
+     * Ignored if `creator` is set.
+     */
+    bool arena_strings = false;
+
+    /**
+     * Whether to store strings in `StringViewField`s, which refer directly to the input buffer where possible.
+     * This avoids copying most strings when parsing contiguous inputs, e.g., from `read_buffer()` or memory-mapped files.
+     * For `read_buffer()` and contiguous readers in `read()`, the caller is responsible for keeping the buffer alive while the `Contents` are in use;
+     * otherwise, the buffer is owned by `Contents::backing`.
+     * Takes precedence over `arena_strings`, and is ignored if `creator` is set.
+     */
+    bool string_views = false;
+
+    /**
+     * Whether to record missing values with a validity bitmap, i.e., in `MaskedField`s instead of `FilledField`s.
+     * This reduces memory usage for fields with many missing values, especially for fields that start with a long run of missing values.
+     * Only affects string fields if `arena_strings` and `string_views` are both `false`, and is ignored if `creator` is set.
+     */
+    bool missing_bitmap = false;
+
     /**
      * Pointer to an instance of a concrete `FieldCreator` subclass.
      * If `NULL`, it defaults to an instance of an internal subclass that creates `FilledField` objects (or `DummyField`, if `dummy = true` in the `FieldCreator::create()` calls).
@@ -59,6 +139,81 @@ struct ReadOptions {
      * Values outside of this range will be ignored.
      */
     std::vector<int> keep_subset_indices;
+
+    /**
+     * Level of validation for fields that are not stored, i.e., those represented by dummy placeholders when `validate_only = true` or `keep_subset = true`.
+     * Lower levels avoid converting the values of such fields, which is faster when only a few fields are stored.
+     * This only takes effect after the type of each field is determined from its first non-missing value,
+     * and is ignored for fields from `creator` that report `Field::filled()` as `true`.
+     */
+    ValidationLevel dummy_validation = ValidationLevel::FULL;
+
+    /**
+     * Number of records to skip at the start of the file, after the header.
+     * Skipped records are not validated beyond tracking the quotes to find the end of each record.
+     * Line numbers in error messages still count the skipped records.
+     */
+    size_t skip_records = 0;
+
+    /**
+     * Maximum number of records to read after skipping `skip_records`.
+     * Parsing stops as soon as this number of records is read, so any subsequent records are not validated;
+     * for streaming readers with `num_threads = 1`, the rest of the file is not even read (or decompressed).
+     */
+    size_t max_records = std::numeric_limits<size_t>::max();
+
+    /**
+     * Pointer to a `RecordIndex` in which to store the offsets of the records, sampled at intervals of `RecordIndex::interval`.
+     * The index can be saved to a sidecar file with `save_record_index()` for use in later reads of the same file, e.g., via `split_index`.
+     * If `NULL`, no index is built.
+     * An error is raised if this is set together with `skip_records` or `max_records`.
+     */
+    RecordIndex* record_index = nullptr;
+
+    /**
+     * Pointer to a `RecordIndex` for the same file, typically created by an earlier read with `record_index`.
+     * If `num_threads > 1`, the records are split into chunks at the sampled offsets, avoiding an extra pass over the file to find the record boundaries;
+     * it is also used to jump directly to the closest sampled record when skipping `skip_records`.
+     * An error is raised if the size of the file is not the same as `RecordIndex::size`.
+     * Ignored if `NULL` or `num_threads = 1`.
+     */
+    const RecordIndex* split_index = nullptr;
+
+    /**
+     * Pointer to a `GzipIndex` for a Gzipped file, typically created by `build_gzip_index()`.
+     * If `num_threads > 1`, `read_file()` decompresses the file in parallel by resuming from each access point,
+     * and `read_rows()` resumes decompression from the closest access point instead of the start of the file.
+     * Ignored if `NULL` or if the file is not Gzipped.
+     * Only used if Zlib is available.
+     */
+    const GzipIndex* gzip_index = nullptr;
+
+    /**
+     * Pointer to a `ParseStats` object, to be filled with statistics about the parse.
+     * This is reset at the start of each call to `read()`, `read_buffer()` or `read_file()`; it is not used by other functions.
+     * Ignored if `NULL`, in which case no statistics are collected.
+     */
+    ParseStats* stats = nullptr;
+
+    /**
+     * Function to be called with the progress of the read, after every `progress_records` records or `progress_bytes` bytes.
+     * If this returns `false`, the read is cancelled; the partially filled `Contents` is cleared and a `ReadCancelled` error is thrown.
+     * If `num_threads > 1`, this may be called from different threads, though never concurrently.
+     * Only used by `read()`, `read_buffer()` and `read_file()`.
+     */
+    std::function<bool(const ReadProgress&)> progress;
+
+    /**
+     * Number of bytes between calls to `progress`.
+     * Ignored if zero.
+     */
+    uint64_t progress_bytes = 16777216;
+
+    /**
+     * Number of records between calls to `progress`.
+     * Ignored if zero.
+     */
+    uint64_t progress_records = 0;
 };
 
 /**
@@ -68,6 +223,14 @@ namespace internals {
 
 inline Parser configure_parser(const FieldCreator* creator, const ReadOptions& options) {
     Parser parser(creator);
+    parser.set_detect_integers(options.detect_integers);
+    parser.set_dummy_validation(options.dummy_validation);
+    parser.set_skip_records(options.skip_records);
+    parser.set_max_records(options.max_records);
+    parser.set_record_index(options.record_index);
+    parser.set_split_index(options.split_index);
+    parser.set_stats(options.stats);
+    parser.set_progress(&(options.progress), options.progress_bytes, options.progress_records);
     if (options.keep_subset) {
         parser.set_check_store(true);
         parser.set_store_by_name(options.keep_subset_names);
@@ -76,6 +239,97 @@ inline Parser configure_parser(const FieldCreator* creator, const ReadOptions& o
     return parser;
 }
 
+inline DefaultFieldCreator<false> default_creator(const ReadOptions& options) {
+    return DefaultFieldCreator<false>(options.arena_strings, options.string_views, options.missing_bitmap);
+}
+
+template<class Function>
+void dispatch(const ReadOptions& options, Function fun) {
+    if (options.validate_only) {
+        DefaultFieldCreator<true> creator;
+        fun(configure_parser(&creator, options));
+    } else if (options.creator) {
+        fun(configure_parser(options.creator, options));
+    } else {
+        auto creator = default_creator(options);
+        fun(configure_parser(&creator, options));
+    }
+}
+
+template<class Reader>
+std::vector<char> load_all(Reader& reader) {
+    std::vector<char> buffer;
+    size_t chunk_size = 65536;
+    while (1) {
+        size_t current = buffer.size();
+        buffer.resize(current + chunk_size);
+        size_t got = reader.read(reinterpret_cast<unsigned char*>(buffer.data() + current), chunk_size);
+        buffer.resize(current + got);
+        if (got == 0) {
+            break;
+        }
+        chunk_size = std::max(chunk_size, current);
+    }
+    return buffer;
+}
+
+inline void reset_stats(const ReadOptions& options) {
+    if (options.stats) {
+        *(options.stats) = ParseStats();
+    }
+}
+
+inline void parse_buffer(const Parser& parser, const char* buffer, size_t n, Contents& contents, const ReadOptions& options) {
+    auto start = std::chrono::steady_clock::now();
+    if (options.num_threads > 1) {
+        // Chunks always use the default fields, which are merged into the fields from the user-supplied creator.
+        if (options.validate_only) {
+            DefaultFieldCreator<true> chunk_creator;
+            parser.parse_chunked(buffer, n, contents, options.num_threads, &chunk_creator);
+        } else {
+            auto chunk_creator = default_creator(options);
+            parser.parse_chunked(buffer, n, contents, options.num_threads, &chunk_creator);
+        }
+    } else {
+        parser.parse_buffer(buffer, n, contents);
+    }
+
+    if (options.stats) {
+        options.stats->parse_time += seconds_since(start);
+        options.stats->peak_buffered = std::max(options.stats->peak_buffered, static_cast<uint64_t>(n));
+    }
+}
+
+template<class Reader, typename = void>
+struct is_contiguous : std::false_type {};
+
+template<class Reader>
+struct is_contiguous<Reader, std::void_t<decltype(std::declval<const Reader&>().data()), decltype(std::declval<const Reader&>().size())> > : std::true_type {};
+
+template<class Reader>
+void parse(const Parser& parser, Reader& reader, Contents& contents, const ReadOptions& options) {
+    if constexpr(is_contiguous<Reader>::value) {
+        parse_buffer(parser, reinterpret_cast<const char*>(reader.data()), reader.size(), contents, options);
+    } else if ((options.num_threads > 1 && options.max_records == std::numeric_limits<size_t>::max()) || options.string_views) {
+        // String views need a persistent buffer, so we might as well load everything.
+        // Otherwise, if we only need a few records, it's faster to stream them in serial.
+        auto start = std::chrono::steady_clock::now();
+        auto buffer = std::make_shared<std::vector<char> >(load_all(reader));
+        if (options.stats) {
+            options.stats->read_time += seconds_since(start);
+            options.stats->peak_buffered = buffer->capacity();
+        }
+        parse_buffer(parser, buffer->data(), buffer->size(), contents, options);
+        if (options.string_views) {
+            contents.backing = std::move(buffer);
+        }
+    } else {
+        with_buffered_input(&reader, options.parallel, options.buffer_size, options.prefetch_depth, options.stats, [&](auto& input) -> void {
+            parser.parse(input, contents);
+        });
+    }
+}
+
 }
 /**
  * @endcond
@@ -94,21 +348,16 @@ inline Parser configure_parser(const FieldCreator* creator, const ReadOptions& o
  * `contents` can also contain pre-filled `Contents::fields`, which will be directly used for storing data from each column.
  * This is useful if the types of all columns are known in advance, and/or if certain columns need special handling via `Field` subclasses.
  * Any pre-filled field with an `UNKNOWN` type will be replaced via `Creator::create()`.
+ *
+ * If `Reader` also has `data()` and `size()` methods that expose the entire input as a contiguous in-memory buffer,
+ * the buffer is parsed directly, see `read_buffer()` for details.
  */
 template<class Reader>
 void read(Reader& reader, Contents& contents, const ReadOptions& options) {
-    if (options.validate_only) {
-        DefaultFieldCreator<true> creator;
-        auto parser = internals::configure_parser(&creator, options);
-        parser.parse(reader, contents, options.parallel);
-    } else if (options.creator) {
-        auto parser = internals::configure_parser(options.creator, options);
-        parser.parse(reader, contents, options.parallel);
-    } else {
-        DefaultFieldCreator<false> creator;
-        auto parser = internals::configure_parser(&creator, options);
-        parser.parse(reader, contents, options.parallel);
-    }
+    internals::reset_stats(options);
+    internals::dispatch(options, [&](const Parser& parser) -> void {
+        internals::parse(parser, reader, contents, options);
+    });
 }
 
 /**
@@ -126,22 +375,94 @@ Contents read(Reader& reader, const ReadOptions& options) {
     return output;
 }
 
+/**
+ * @param buffer Pointer to an in-memory buffer containing the contents of a CSV file.
+ * @param n Length of the buffer.
+ * @param contents `Contents` to store the parsed contents of the file, see the `read()` overload for details.
+ * @param options Reading options.
+ *
+ * This is more efficient than calling `read()` on a `byteme::RawBufferReader`,
+ * as the parser operates directly on the buffer rather than copying it into its own buffers.
+ * `ReadOptions::parallel` has no effect here as there is no reading to be done.
+ */
+inline void read_buffer(const char* buffer, size_t n, Contents& contents, const ReadOptions& options) {
+    internals::reset_stats(options);
+    internals::dispatch(options, [&](const Parser& parser) -> void {
+        internals::parse_buffer(parser, buffer, n, contents, options);
+    });
+}
+
+/**
+ * @param buffer Pointer to an in-memory buffer containing the contents of a CSV file.
+ * @param n Length of the buffer.
+ * @param options Reading options.
+ *
+ * @return The `Contents` of the CSV file.
+ */
+inline Contents read_buffer(const char* buffer, size_t n, const ReadOptions& options) {
+    Contents output;
+    read_buffer(buffer, n, output, options);
+    return output;
+}
+
 /**
  * @param path Path to a (possibly Gzipped) CSV file.
  * @param contents `Contents` to store the parsed contents of the file, see the `read()` overload for details.
  * @param options Reading options.
  *
  * Gzip support requires linking to the Zlib library.
+ * Uncompressed files are memory-mapped if `ReadOptions::memory_map = true`.
+ * If `ReadOptions::num_threads > 1`, Gzipped files in the BGZF format (e.g., from `BlockedGzipWriter`) are also decompressed in parallel, see `ParallelGzipReader`.
  */
 inline void read_file(const char* path, Contents& contents, const ReadOptions& options) {
     std::unique_ptr<byteme::Reader> reader;
 #if __has_include("zlib.h")
-    if (byteme::is_gzip(path)) {
+    bool gzipped = byteme::is_gzip(path);
+#else
+    bool gzipped = false;
+#endif
+
+#ifdef COMSERVATORY_HAS_MMAP
+    if (options.memory_map && !gzipped) {
+        auto mapped = std::make_shared<MappedFile>(path, options.huge_pages);
+        internals::reset_stats(options);
+        internals::dispatch(options, [&](const Parser& parser) -> void {
+            internals::parse_buffer(parser, mapped->data(), mapped->size(), contents, options);
+        });
+        if (options.string_views) {
+            contents.backing = std::move(mapped);
+        }
+        return;
+    }
+#endif
+
+#if __has_include("zlib.h")
+    if (gzipped && options.gzip_index && options.num_threads > 1 && options.max_records == std::numeric_limits<size_t>::max()) {
+        internals::reset_stats(options);
+        auto start = std::chrono::steady_clock::now();
+        auto buffer = std::make_shared<std::vector<char> >(internals::inflate_all(path, *(options.gzip_index), options.num_threads));
+        if (options.stats) {
+            options.stats->read_time = internals::seconds_since(start);
+        }
+        internals::dispatch(options, [&](const Parser& parser) -> void {
+            internals::parse_buffer(parser, buffer->data(), buffer->size(), contents, options);
+        });
+        if (options.string_views) {
+            contents.backing = std::move(buffer);
+        }
+        return;
+    }
+
+    if (gzipped && options.num_threads > 1) {
+        // Only BGZF files are decompressed in parallel, otherwise this falls back to the usual reader.
+        reader.reset(new ParallelGzipReader(path, options.num_threads));
+    } else if (gzipped) {
         reader.reset(new byteme::GzipFileReader(path, {}));
     } else {
         reader.reset(new byteme::RawFileReader(path, {}));
     }
 #else
+    (void)gzipped;
     reader.reset(new byteme::RawFileReader(path, {}));
 #endif
     read(*reader, contents, options);
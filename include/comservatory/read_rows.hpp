@@ -0,0 +1,270 @@
+#ifndef COMSERVATORY_READ_ROWS_HPP
+#define COMSERVATORY_READ_ROWS_HPP
+
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <stdexcept>
+#include <memory>
+
+#include "Type.hpp"
+#include "Field.hpp"
+#include "Parser.hpp"
+#include "RecordIndex.hpp"
+#include "GzipIndex.hpp"
+#include "read.hpp"
+
+#include "byteme/byteme.hpp"
+
+/**
+ * @file read_rows.hpp
+ *
+ * @brief Read a range of records from a CSV file with a `RecordIndex`.
+ */
+
+namespace comservatory {
+
+/**
+ * @cond
+ */
+namespace internals {
+
+inline void mismatched_index() {
+    throw std::runtime_error("record index does not match the contents of the file");
+}
+
+// Reads an uncompressed file from 'offset', after checking that the file
+// matches the index and that the preceding character is a newline.
+class OffsetFileReader : public byteme::Reader {
+public:
+    OffsetFileReader(const char* path, const RecordIndex& index, uint64_t offset) {
+        handle = std::fopen(path, "rb");
+        if (handle == NULL) {
+            throw std::runtime_error("failed to open file at '" + std::string(path) + "'");
+        }
+
+        if (std::fseek(handle, 0, SEEK_END) != 0 || static_cast<uint64_t>(std::ftell(handle)) != index.size) {
+            std::fclose(handle);
+            throw std::runtime_error("record index does not match the size of the file");
+        }
+
+        if (std::fseek(handle, offset - 1, SEEK_SET) != 0 || std::fgetc(handle) != '\n') {
+            std::fclose(handle);
+            mismatched_index();
+        }
+    }
+
+    ~OffsetFileReader() {
+        std::fclose(handle);
+    }
+
+    OffsetFileReader(const OffsetFileReader&) = delete;
+    OffsetFileReader& operator=(const OffsetFileReader&) = delete;
+
+    size_t read(unsigned char* buffer, size_t n) {
+        return std::fread(buffer, 1, n, handle);
+    }
+
+private:
+    std::FILE* handle;
+};
+
+// Compressed streams can't be seeked, so we just discard everything before 'offset'.
+template<class Input>
+void discard_bytes(Input& input, uint64_t offset) {
+    char last = '\n';
+    for (uint64_t i = 0; i < offset; ++i) {
+        if (!input.valid()) {
+            mismatched_index();
+        }
+        last = input.get();
+        input.advance();
+    }
+    if (last != '\n') {
+        mismatched_index();
+    }
+}
+
+template<class Input>
+void parse_rows(const Parser& parser, Input& input, size_t first, size_t skip, size_t n, Contents& contents) {
+    size_t line = first - skip + 1;
+    line += Parser::skip_ahead(input, skip);
+    if (!input.valid()) {
+        mismatched_index();
+    }
+    parser.parse_records(input, contents, line, n);
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @param path Path to a (possibly Gzipped) CSV file.
+ * @param index Index of the records in the file at `path`, typically created by `read()` with `ReadOptions::record_index` and loaded with `load_record_index()`.
+ * @param begin Index of the first record to read, where record 0 is the first record after the header.
+ * @param end Index of one past the last record to read.
+ * This should be no greater than `RecordIndex::num_records`.
+ * @param contents `Contents` to store the parsed records.
+ * This may contain pre-filled `Contents::names` and `Contents::fields`, see `read()` for details.
+ * @param options Reading options.
+ * `ReadOptions::num_threads`, `ReadOptions::memory_map`, `ReadOptions::skip_records`, `ReadOptions::max_records`, `ReadOptions::record_index` and `ReadOptions::split_index` are ignored.
+ *
+ * Records `[begin, end)` are parsed into `contents` without parsing the rest of the file.
+ * Uncompressed files are read directly from the closest sampled record before `begin`.
+ * Gzipped files must still be decompressed (but not parsed) up to that record,
+ * unless `ReadOptions::gzip_index` is supplied, in which case decompression is resumed from the closest access point.
+ * Parsing stops after the `end - 1`-th record, so subsequent records are not read.
+ *
+ * The names and types of the fields are taken from `RecordIndex::names` and `RecordIndex::types`, rather than from the file itself.
+ * Each field is created with the `FieldCreator` in `ReadOptions::creator` (or the default creator) before parsing, so its type is consistent across different ranges of the same file.
+ * The parsed records are still validated against these types, and integers are always detected if any field is of type `INTEGER`.
+ *
+ * Gzip support requires linking to the Zlib library.
+ */
+inline void read_rows(const char* path, const RecordIndex& index, size_t begin, size_t end, Contents& contents, const ReadOptions& options) {
+    if (begin > end || end > index.num_records) {
+        throw std::runtime_error("requested records are out of range of the record index");
+    }
+    if (index.names.size() != index.types.size()) {
+        throw std::runtime_error("record index does not contain a type for each field");
+    }
+
+    if (contents.names.empty()) {
+        contents.names = index.names;
+    } else if (contents.names != index.names) {
+        throw std::runtime_error("provided names are not equal to the names in the record index");
+    }
+
+    bool has_integers = false;
+    for (auto t : index.types) {
+        has_integers = has_integers || t == INTEGER;
+    }
+
+    internals::dispatch(options, [&](const Parser& base) -> void {
+        Parser parser(base);
+        parser.set_detect_integers(options.detect_integers || has_integers);
+        parser.set_record_index();
+        parser.set_split_index();
+
+        size_t nfields = index.names.size();
+        if (contents.fields.empty()) {
+            contents.fields.resize(nfields);
+            for (size_t c = 0; c < nfields; ++c) {
+                auto t = index.types[c];
+                if (t == UNKNOWN) {
+                    contents.fields[c].reset(new UnknownField);
+                } else {
+                    contents.fields[c].reset(parser.create_field(contents, t, c, 0));
+                }
+            }
+        } else if (contents.fields.size() != nfields) {
+            throw std::runtime_error("provided number of fields is not equal to the number of names in the record index");
+        }
+
+        if (begin == end) {
+            return;
+        }
+
+        size_t skip;
+        uint64_t offset = index.locate(begin, skip);
+
+#if __has_include("zlib.h")
+        if (byteme::is_gzip(path)) {
+            if (options.gzip_index) {
+                if (options.gzip_index->size != index.size) {
+                    throw std::runtime_error("record index does not match the size of the file");
+                }
+
+                // Resuming from the closest access point, including the preceding newline for the sanity check.
+                GzipIndexedReader reader(path, *(options.gzip_index), offset - 1);
+                byteme::SerialBufferedReader<char, byteme::Reader*> input(&reader, options.buffer_size);
+                internals::discard_bytes(input, 1);
+                internals::parse_rows(parser, input, begin, skip, end - begin, contents);
+            } else {
+                byteme::GzipFileReader reader(path, {});
+                byteme::SerialBufferedReader<char, byteme::Reader*> input(&reader, options.buffer_size);
+                internals::discard_bytes(input, offset);
+                internals::parse_rows(parser, input, begin, skip, end - begin, contents);
+            }
+            return;
+        }
+#endif
+
+        internals::OffsetFileReader reader(path, index, offset);
+        internals::with_buffered_input(&reader, options.parallel, options.buffer_size, options.prefetch_depth, nullptr, [&](auto& input) -> void {
+            internals::parse_rows(parser, input, begin, skip, end - begin, contents);
+        });
+    });
+}
+
+/**
+ * @param path Path to a (possibly Gzipped) CSV file.
+ * @param index Index of the records in the file at `path`.
+ * @param begin Index of the first record to read.
+ * @param end Index of one past the last record to read.
+ * @param options Reading options.
+ *
+ * @return The `Contents` of records `[begin, end)`, see the other `read_rows()` overload for details.
+ */
+inline Contents read_rows(const char* path, const RecordIndex& index, size_t begin, size_t end, const ReadOptions& options) {
+    Contents output;
+    read_rows(path, index, begin, end, output, options);
+    return output;
+}
+
+/**
+ * @param path Path to a (possibly Gzipped) CSV file.
+ * @param index Index of the records in the file at `path`.
+ * @param begin Index of the first record to read.
+ * @param end Index of one past the last record to read.
+ *
+ * @return The `Contents` of records `[begin, end)`, see the other `read_rows()` overload for details.
+ */
+inline Contents read_rows(const char* path, const RecordIndex& index, size_t begin, size_t end) {
+    return read_rows(path, index, begin, end, ReadOptions());
+}
+
+/**
+ * @param path Path to a (possibly Gzipped) CSV file.
+ * @param index Index of the records in the file at `path`.
+ * @param begin Index of the first record to read.
+ * @param end Index of one past the last record to read.
+ * @param contents `Contents` to store the parsed records.
+ * @param options Reading options.
+ *
+ * See the other `read_rows()` overload for details.
+ */
+inline void read_rows(const std::string& path, const RecordIndex& index, size_t begin, size_t end, Contents& contents, const ReadOptions& options) {
+    read_rows(path.c_str(), index, begin, end, contents, options);
+}
+
+/**
+ * @param path Path to a (possibly Gzipped) CSV file.
+ * @param index Index of the records in the file at `path`.
+ * @param begin Index of the first record to read.
+ * @param end Index of one past the last record to read.
+ * @param options Reading options.
+ *
+ * @return The `Contents` of records `[begin, end)`, see the other `read_rows()` overload for details.
+ */
+inline Contents read_rows(const std::string& path, const RecordIndex& index, size_t begin, size_t end, const ReadOptions& options) {
+    return read_rows(path.c_str(), index, begin, end, options);
+}
+
+/**
+ * @param path Path to a (possibly Gzipped) CSV file.
+ * @param index Index of the records in the file at `path`.
+ * @param begin Index of the first record to read.
+ * @param end Index of one past the last record to read.
+ *
+ * @return The `Contents` of records `[begin, end)`, see the other `read_rows()` overload for details.
+ */
+inline Contents read_rows(const std::string& path, const RecordIndex& index, size_t begin, size_t end) {
+    return read_rows(path.c_str(), index, begin, end, ReadOptions());
+}
+
+}
+
+#endif
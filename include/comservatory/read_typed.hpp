@@ -0,0 +1,427 @@
+#ifndef COMSERVATORY_READ_TYPED_HPP
+#define COMSERVATORY_READ_TYPED_HPP
+
+#include <vector>
+#include <string>
+#include <complex>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+
+#include "Type.hpp"
+#include "Field.hpp"
+#include "convert.hpp"
+#include "input.hpp"
+#include "Parser.hpp"
+#include "read.hpp"
+
+#include "byteme/byteme.hpp"
+
+/**
+ * @file read_typed.hpp
+ *
+ * @brief Read a CSV file with a schema that is known at compile time.
+ */
+
+namespace comservatory {
+
+/**
+ * @brief C++ type used to store the values of a field of type `tt`.
+ * @tparam tt Type of the field, should not be `UNKNOWN`.
+ */
+template<Type tt>
+struct TypedValue;
+
+/**
+ * @cond
+ */
+template<>
+struct TypedValue<STRING> {
+    typedef std::string type;
+};
+
+template<>
+struct TypedValue<NUMBER> {
+    typedef double type;
+};
+
+template<>
+struct TypedValue<INTEGER> {
+    typedef int64_t type;
+};
+
+template<>
+struct TypedValue<BOOLEAN> {
+    typedef bool type;
+};
+
+template<>
+struct TypedValue<COMPLEX> {
+    typedef std::complex<double> type;
+};
+/**
+ * @endcond
+ */
+
+/**
+ * @brief The parsed contents of a CSV file with a known schema.
+ * @tparam types Type of each field in the CSV file.
+ *
+ * Unlike `Contents`, the type of each field is fixed at compile time,
+ * so the values can be accessed directly without any casting, e.g., `std::get<0>(contents.fields).values`.
+ */
+template<Type... types>
+struct TypedContents {
+    /**
+     * Tuple of data for each of the fields in the CSV file.
+     * Missing values are recorded in `FilledField::missing` and are default-constructed in `FilledField::values`.
+     */
+    std::tuple<FilledField<typename TypedValue<types>::type, types>...> fields;
+
+    /**
+     * Vector of names for the fields in the CSV file.
+     * This is of length equal to the number of `types`.
+     */
+    std::vector<std::string> names;
+
+    /**
+     * @return Number of fields in the CSV file.
+     */
+    static constexpr size_t num_fields() {
+        return sizeof...(types);
+    }
+
+    /**
+     * @return Number of records in the CSV file.
+     */
+    size_t num_records() const {
+        if constexpr(sizeof...(types) > 0) {
+            return std::get<0>(fields).size();
+        } else {
+            return fallback;
+        }
+    }
+
+    /**
+     * @cond
+     */
+    size_t fallback = 0;
+    /**
+     * @endcond
+     */
+};
+
+/**
+ * @cond
+ */
+namespace internals {
+
+// 'tt' is the expected type of the current field, or UNKNOWN if the field
+// lies beyond the end of the schema. We mimic the Parser's error messages for
+// type mismatches and extra fields, which are thrown before parsing a string
+// or after parsing any other value.
+template<Type tt>
+[[noreturn]] void typed_mismatch(size_t line) {
+    if constexpr(tt == UNKNOWN) {
+        throw std::runtime_error("more fields on line " + std::to_string(line + 1) + " than expected from the header");
+    } else {
+        throw std::runtime_error("previous and current types do not match up");
+    }
+}
+
+template<Type tt, Type observed, class Output, typename T>
+void typed_store(Output* field, size_t line, T value) {
+    if constexpr(tt == observed) {
+        field->values.push_back(value);
+    } else {
+        typed_mismatch<tt>(line);
+    }
+}
+
+template<Type tt, class Output>
+void typed_missing(Output* field, size_t line) {
+    if constexpr(tt == UNKNOWN) {
+        typed_mismatch<tt>(line);
+    } else {
+        auto& values = field->values;
+        field->missing.push_back(values.size());
+        values.emplace_back();
+    }
+}
+
+template<Type tt, class Input, class Output>
+void typed_number_or_complex(Input& input, Output* field, size_t column, size_t line, bool negative) {
+    IntegerCapture integer;
+    auto first = to_number(input, column, line, tt == INTEGER ? &integer : NULL);
+    if (negative) {
+        first *= -1;
+    }
+
+    char next = input.get(); // no need to check validity, as to_number always leaves us on a valid position (or throws itself).
+    if (next == ',' || next == '\n') {
+        if constexpr(tt == INTEGER) {
+            int64_t value;
+            if (to_int64(integer, negative, value)) {
+                field->values.push_back(value);
+                return;
+            }
+        }
+        typed_store<tt, NUMBER>(field, line, first);
+        return;
+    }
+
+    auto second = to_imaginary(input, column, line);
+    typed_store<tt, COMPLEX>(field, line, std::complex<double>(first, second));
+}
+
+template<Type tt, class Input, class Output>
+void typed_inf(Input& input, Output* field, size_t column, size_t line, bool negative) {
+    input.advance();
+    expect_fixed(input, "nf", "NF", column, line); // i.e., Inf or any of its capitalizations.
+    double val = std::numeric_limits<double>::infinity();
+    if (negative) {
+        val *= -1;
+    }
+    typed_store<tt, NUMBER>(field, line, val);
+}
+
+template<Type tt, class Input, class Output>
+void typed_nan(Input& input, Output* field, size_t column, size_t line) {
+    input.advance();
+    expect_fixed(input, "an", "AN", column, line); // i.e., NaN or any of its capitalizations.
+    typed_store<tt, NUMBER>(field, line, std::numeric_limits<double>::quiet_NaN());
+}
+
+// Same grammar as Parser::parse_records(), but each case is resolved at
+// compile time into either a store or a mismatch error.
+template<Type tt, class Input, class Output>
+void parse_typed_cell(Input& input, Output* field, size_t column, size_t line) {
+    switch (input.get()) {
+        case '"':
+            if constexpr(tt == STRING) {
+                auto& values = field->values;
+                values.emplace_back();
+                to_string(input, column, line, values.back());
+            } else {
+                typed_mismatch<tt>(line);
+            }
+            break;
+
+        case 't': case 'T':
+            input.advance();
+            expect_fixed(input, "rue", "RUE", column, line);
+            typed_store<tt, BOOLEAN>(field, line, true);
+            break;
+
+        case 'f': case 'F':
+            input.advance();
+            expect_fixed(input, "alse", "ALSE", column, line);
+            typed_store<tt, BOOLEAN>(field, line, false);
+            break;
+
+        case 'N':
+            if (to_missing_or_nan(input, column, line)) {
+                typed_missing<tt>(field, line);
+            } else {
+                typed_store<tt, NUMBER>(field, line, std::numeric_limits<double>::quiet_NaN());
+            }
+            break;
+
+        case 'n':
+            typed_nan<tt>(input, field, column, line);
+            break;
+
+        case 'i': case 'I':
+            typed_inf<tt>(input, field, column, line, false);
+            break;
+
+        case '0': case '1': case '2': case '3': case '4': case '5': case '6': case '7': case '8': case '9':
+            typed_number_or_complex<tt>(input, field, column, line, false);
+            break;
+
+        case '+':
+            input.advance();
+            if (!input.valid()) {
+                throw std::runtime_error("truncated field in " + get_location(column, line));
+            } else if (!std::isdigit(input.get())) {
+                throw std::runtime_error("invalid number in " + get_location(column, line));
+            }
+            typed_number_or_complex<tt>(input, field, column, line, false);
+            break;
+
+        case '-':
+            {
+                input.advance();
+                if (!input.valid()) {
+                    throw std::runtime_error("truncated field in " + get_location(column, line));
+                }
+
+                char next = input.get();
+                if (next == 'i' || next == 'I') {
+                    typed_inf<tt>(input, field, column, line, true);
+                } else if (next == 'n' || next == 'N') {
+                    typed_nan<tt>(input, field, column, line);
+                } else if (std::isdigit(next)) {
+                    typed_number_or_complex<tt>(input, field, column, line, true);
+                } else {
+                    throw std::runtime_error("incorrectly formatted number in " + get_location(column, line));
+                }
+            }
+            break;
+
+        case '\n':
+            throw std::runtime_error(get_location(column, line) + " is empty");
+
+        default:
+            throw std::runtime_error("unknown type starting with '" + std::string(1, input.get()) + "' in " + get_location(column, line));
+    }
+}
+
+template<size_t i, Type first, Type... rest>
+struct TypeAt {
+    static constexpr Type value = TypeAt<i - 1, rest...>::value;
+};
+
+template<Type first, Type... rest>
+struct TypeAt<0, first, rest...> {
+    static constexpr Type value = first;
+};
+
+// Parses the i-th field of a record, along with its trailing delimiter.
+template<size_t i, class Input, Type... types>
+void parse_typed_field(Input& input, TypedContents<types...>& output, size_t line) {
+    constexpr size_t ncols = sizeof...(types);
+    parse_typed_cell<TypeAt<i, types...>::value>(input, &std::get<i>(output.fields), i, line);
+
+    if (!input.valid()) {
+        throw std::runtime_error("last line must be terminated by a single newline");
+    }
+
+    char next = input.get();
+    input.advance();
+    if (next == ',') {
+        if (!input.valid()) {
+            throw std::runtime_error("line " + std::to_string(line + 1) + " is truncated at column " + std::to_string(i + 2));
+        }
+        if constexpr(i + 1 == ncols) {
+            // This always throws, possibly after checking that the extra field is valid.
+            parse_typed_cell<UNKNOWN>(input, static_cast<void*>(NULL), i + 1, line);
+        }
+    } else if (next == '\n') {
+        if constexpr(i + 1 != ncols) {
+            throw std::runtime_error("line " + std::to_string(line + 1) + " has fewer fields than expected from the header");
+        }
+    } else {
+        throw std::runtime_error(get_location(i, line) + " contains trailing character '" + std::string(1, next) + "'");
+    }
+}
+
+template<class Input, Type... types, size_t... i>
+void parse_typed_record(Input& input, TypedContents<types...>& output, size_t line, std::index_sequence<i...>) {
+    (parse_typed_field<i>(input, output, line), ...);
+}
+
+template<class Input, Type... types>
+void parse_typed(Input& input, TypedContents<types...>& output) {
+    Contents header;
+    header.names.swap(output.names);
+    bool remaining = Parser(NULL).parse_header(input, header);
+    if (header.names.size() != sizeof...(types)) {
+        throw std::runtime_error("number of types is not equal to the number of header names");
+    }
+    output.names.swap(header.names);
+    output.fallback = header.num_records();
+
+    if constexpr(sizeof...(types) > 0) {
+        if (remaining) {
+            size_t line = 1;
+            while (1) {
+                parse_typed_record(input, output, line, std::make_index_sequence<sizeof...(types)>());
+                if (!input.valid()) {
+                    break;
+                }
+                ++line;
+            }
+        }
+    }
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @tparam types Type of each field in the CSV file, excluding `UNKNOWN`.
+ *
+ * @param buffer Pointer to an in-memory buffer containing the contents of a CSV file.
+ * @param n Length of the buffer.
+ * @param contents `TypedContents` to store the parsed contents of the file.
+ * This may contain pre-filled `TypedContents::names`, which will be checked against the header names in the file.
+ *
+ * This performs the same validation as `read_buffer()`, but the parsing of each field is specialized at compile time for its type.
+ * An error is thrown if the number of header names is not equal to the number of `types`, or if any value is not of the expected type.
+ * Missing values are allowed in any field.
+ * For `INTEGER` fields, only integer-formatted numbers that fit into a signed 64-bit integer are allowed.
+ */
+template<Type... types>
+void read_typed_buffer(const char* buffer, size_t n, TypedContents<types...>& contents) {
+    BufferInput input(buffer, buffer + n);
+    internals::parse_typed(input, contents);
+}
+
+/**
+ * @tparam types Type of each field in the CSV file, excluding `UNKNOWN`.
+ *
+ * @param buffer Pointer to an in-memory buffer containing the contents of a CSV file.
+ * @param n Length of the buffer.
+ *
+ * @return The `TypedContents` of the CSV file.
+ */
+template<Type... types>
+TypedContents<types...> read_typed_buffer(const char* buffer, size_t n) {
+    TypedContents<types...> output;
+    read_typed_buffer(buffer, n, output);
+    return output;
+}
+
+/**
+ * @tparam types Type of each field in the CSV file, excluding `UNKNOWN`.
+ * @tparam Reader A reader class that implements the same methods as `bytme::Reader`.
+ *
+ * @param reader Instance of a `Reader` class, containing the data stream for a CSV file.
+ * @param contents `TypedContents` to store the parsed contents of the file, see `read_typed_buffer()` for details.
+ *
+ * If `Reader` also has `data()` and `size()` methods, the buffer is parsed directly, see `read()` for details.
+ */
+template<Type... types, class Reader>
+void read_typed(Reader& reader, TypedContents<types...>& contents) {
+    if constexpr(internals::is_contiguous<Reader>::value) {
+        read_typed_buffer(reinterpret_cast<const char*>(reader.data()), reader.size(), contents);
+    } else {
+        byteme::SerialBufferedReader<char, byteme::Reader*> input(&reader, 65536);
+        internals::parse_typed(input, contents);
+    }
+}
+
+/**
+ * @tparam types Type of each field in the CSV file, excluding `UNKNOWN`.
+ * @tparam Reader A reader class that implements the same methods as `bytme::Reader`.
+ *
+ * @param reader Instance of a `Reader` class, containing the data stream for a CSV file.
+ *
+ * @return The `TypedContents` of the CSV file.
+ */
+template<Type... types, class Reader>
+TypedContents<types...> read_typed(Reader& reader) {
+    TypedContents<types...> output;
+    read_typed(reader, output);
+    return output;
+}
+
+}
+
+#endif
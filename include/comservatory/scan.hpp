@@ -0,0 +1,282 @@
+#ifndef COMSERVATORY_SCAN_HPP
+#define COMSERVATORY_SCAN_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace comservatory {
+
+/*
+ * Block-wise classification of the structural characters in a CSV buffer.
+ * Each 64-byte block is converted into bitmasks where the i-th bit is set if
+ * the i-th byte of the block is a double quote, comma or newline. This uses
+ * AVX2 or SSE2 compares where the compiler allows it, and a scalar loop
+ * otherwise; all implementations give the same results.
+ *
+ * Quoted regions are identified from the prefix XOR of the quote mask, in the
+ * same manner as simdjson. Escaped quotes ("") toggle the state twice and so
+ * do not need any special handling; the opening quote is considered to be
+ * inside the string and the closing quote is considered to be outside.
+ */
+
+static constexpr size_t scan_block_size = 64;
+
+struct BlockMasks {
+    uint64_t quote = 0;
+    uint64_t comma = 0;
+    uint64_t newline = 0;
+};
+
+inline BlockMasks classify_block_scalar(const char* ptr) {
+    BlockMasks output;
+    for (size_t i = 0; i < scan_block_size; ++i) {
+        uint64_t bit = static_cast<uint64_t>(1) << i;
+        switch (ptr[i]) {
+            case '"':
+                output.quote |= bit;
+                break;
+            case ',':
+                output.comma |= bit;
+                break;
+            case '\n':
+                output.newline |= bit;
+                break;
+        }
+    }
+    return output;
+}
+
+#if defined(__AVX2__)
+inline uint64_t match_block(__m256i lo, __m256i hi, char target) {
+    auto needle = _mm256_set1_epi8(target);
+    uint64_t lower = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, needle)));
+    uint64_t upper = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, needle)));
+    return lower | (upper << 32);
+}
+
+inline BlockMasks classify_block(const char* ptr) {
+    auto lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+    auto hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr + 32));
+    BlockMasks output;
+    output.quote = match_block(lo, hi, '"');
+    output.comma = match_block(lo, hi, ',');
+    output.newline = match_block(lo, hi, '\n');
+    return output;
+}
+
+#elif defined(__SSE2__) || defined(_M_X64)
+inline uint64_t match_block(const __m128i* chunks, char target) {
+    auto needle = _mm_set1_epi8(target);
+    uint64_t output = 0;
+    for (int i = 0; i < 4; ++i) {
+        uint64_t found = static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunks[i], needle)));
+        output |= found << (16 * i);
+    }
+    return output;
+}
+
+inline BlockMasks classify_block(const char* ptr) {
+    __m128i chunks[4];
+    for (int i = 0; i < 4; ++i) {
+        chunks[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 16 * i));
+    }
+    BlockMasks output;
+    output.quote = match_block(chunks, '"');
+    output.comma = match_block(chunks, ',');
+    output.newline = match_block(chunks, '\n');
+    return output;
+}
+
+#else
+inline BlockMasks classify_block(const char* ptr) {
+    return classify_block_scalar(ptr);
+}
+#endif
+
+// Classifies a trailing block of fewer than 64 bytes, ignoring everything past 'n'.
+inline BlockMasks classify_partial_block(const char* ptr, size_t n) {
+    char padded[scan_block_size];
+    std::memset(padded, 0, scan_block_size);
+    std::memcpy(padded, ptr, n);
+    return classify_block(padded);
+}
+
+// Each set bit in the output marks a byte that lies inside a quoted string.
+inline uint64_t prefix_xor(uint64_t x) {
+#if defined(__PCLMUL__)
+    auto all = _mm_set1_epi8(static_cast<char>(0xFF));
+    auto product = _mm_clmulepi64_si128(_mm_set_epi64x(0, static_cast<long long>(x)), all, 0);
+    return static_cast<uint64_t>(_mm_cvtsi128_si64(product));
+#else
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+#endif
+}
+
+inline int count_trailing_zeros(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(x);
+#else
+    int counter = 0;
+    while ((x & 1) == 0) {
+        x >>= 1;
+        ++counter;
+    }
+    return counter;
+#endif
+}
+
+inline int popcount(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#else
+    int counter = 0;
+    while (x) {
+        x &= x - 1;
+        ++counter;
+    }
+    return counter;
+#endif
+}
+
+/*
+ * Streaming scanner that carries the quote state across successive calls, so
+ * that a large buffer can be processed in arbitrary pieces. Each call to
+ * 'next()' returns the masks for the next block of up to 64 bytes, where
+ * 'fields' and 'records' mark the unquoted commas and newlines, respectively.
+ */
+class StructuralScanner {
+public:
+    StructuralScanner(bool in_quotes = false) : carry(in_quotes ? ~static_cast<uint64_t>(0) : 0) {}
+
+    struct Result {
+        uint64_t quote = 0;
+        uint64_t fields = 0;
+        uint64_t records = 0;
+    };
+
+    Result next(const char* ptr, size_t n) {
+        auto masks = (n == scan_block_size ? classify_block(ptr) : classify_partial_block(ptr, n));
+        uint64_t inside = prefix_xor(masks.quote) ^ carry;
+        carry = static_cast<uint64_t>(static_cast<int64_t>(inside) >> 63); // broadcasting the last bit to the entire word.
+
+        Result output;
+        output.quote = masks.quote;
+        output.fields = masks.comma & ~inside;
+        output.records = masks.newline & ~inside;
+        return output;
+    }
+
+    bool in_quotes() const {
+        return carry != 0;
+    }
+
+private:
+    uint64_t carry;
+};
+
+/*
+ * Appends the offsets of all unquoted commas and newlines in '[ptr, ptr + n)'
+ * to 'boundaries', i.e., the ends of every field and record. Offsets are
+ * reported relative to 'ptr' plus 'shift'. Returns the quote state at the end
+ * of the buffer, which can be passed as 'in_quotes' for the next buffer.
+ */
+inline bool find_boundaries(const char* ptr, size_t n, std::vector<size_t>& boundaries, bool in_quotes = false, size_t shift = 0) {
+    StructuralScanner scanner(in_quotes);
+    for (size_t start = 0; start < n; start += scan_block_size) {
+        size_t len = (n - start < scan_block_size ? n - start : scan_block_size);
+        auto res = scanner.next(ptr + start, len);
+        uint64_t found = res.fields | res.records;
+        while (found) {
+            boundaries.push_back(shift + start + count_trailing_zeros(found));
+            found &= found - 1;
+        }
+    }
+    return scanner.in_quotes();
+}
+
+/*
+ * Returns a pointer to the first unquoted newline in '[start, end)', or 'end'
+ * if no such newline exists. 'in_quotes' should specify whether 'start' lies
+ * inside a quoted string.
+ */
+inline const char* find_record_end(const char* start, const char* end, bool in_quotes = false) {
+    StructuralScanner scanner(in_quotes);
+    size_t n = end - start;
+    for (size_t offset = 0; offset < n; offset += scan_block_size) {
+        size_t len = (n - offset < scan_block_size ? n - offset : scan_block_size);
+        auto res = scanner.next(start + offset, len);
+        if (res.records) {
+            return start + offset + count_trailing_zeros(res.records);
+        }
+    }
+    return end;
+}
+
+/*
+ * Returns a pointer to the character after the 'n'-th unquoted newline in
+ * '[start, end)', i.e., the start of the next record after skipping 'n'
+ * records. If there are fewer than 'n' records, 'end' is returned. In both
+ * cases, the number of skipped records is stored in 'skipped'.
+ */
+inline const char* advance_records(const char* start, const char* end, size_t n, size_t& skipped) {
+    StructuralScanner scanner;
+    size_t len = end - start, remaining = n;
+    for (size_t offset = 0; offset < len && remaining; offset += scan_block_size) {
+        size_t block = (len - offset < scan_block_size ? len - offset : scan_block_size);
+        uint64_t records = scanner.next(start + offset, block).records;
+        size_t found = popcount(records);
+        if (found < remaining) {
+            remaining -= found;
+            continue;
+        }
+
+        for (size_t i = 1; i < remaining; ++i) {
+            records &= records - 1;
+        }
+        skipped = n;
+        return start + offset + count_trailing_zeros(records) + 1;
+    }
+
+    skipped = n - remaining;
+    return end;
+}
+
+// Counts the number of double quotes in '[start, end)'. An odd count means
+// that the quote state is flipped from the start to the end of the range.
+inline size_t count_quotes(const char* start, const char* end) {
+    size_t n = end - start, total = 0, offset = 0;
+    for (; offset + scan_block_size <= n; offset += scan_block_size) {
+        total += popcount(classify_block(start + offset).quote);
+    }
+    if (offset < n) {
+        total += popcount(classify_partial_block(start + offset, n - offset).quote);
+    }
+    return total;
+}
+
+// Counts the number of unquoted newlines, i.e., record terminators, in '[start, end)'.
+inline size_t count_records(const char* start, const char* end, bool in_quotes = false) {
+    StructuralScanner scanner(in_quotes);
+    size_t n = end - start, total = 0;
+    for (size_t offset = 0; offset < n; offset += scan_block_size) {
+        size_t len = (n - offset < scan_block_size ? n - offset : scan_block_size);
+        total += popcount(scanner.next(start + offset, len).records);
+    }
+    return total;
+}
+
+}
+
+#endif
@@ -0,0 +1,327 @@
+#ifndef COMSERVATORY_VISIT_HPP
+#define COMSERVATORY_VISIT_HPP
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <complex>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#include "Type.hpp"
+#include "convert.hpp"
+#include "input.hpp"
+#include "Parser.hpp"
+#include "MappedFile.hpp"
+#include "read.hpp"
+
+#include "byteme/byteme.hpp"
+
+/**
+ * @file visit.hpp
+ *
+ * @brief Stream through a CSV file without storing its contents.
+ */
+
+namespace comservatory {
+
+/**
+ * @brief Handler for the contents of a CSV file in `visit()`.
+ *
+ * Each method is called as soon as the corresponding part of the file is parsed, and does nothing by default.
+ * Developers should derive from this class and define methods with the same signatures to handle the events of interest;
+ * as the handler is passed to `visit()` as a template parameter, these methods do not need to be (and should not be) virtual.
+ *
+ * Events are reported in the order in which they occur in the file.
+ * Validation is performed on the fly, so if the file is invalid, some events may be reported before the error is thrown.
+ */
+struct Visitor {
+    /**
+     * @param names Names of the fields, as obtained from the header.
+     * This is called once before any other method.
+     */
+    void header(const std::vector<std::string>& names) {
+        (void)names;
+    }
+
+    /**
+     * @param column Index of the field.
+     * @param value Value of a string.
+     * This view is only valid until the next method call.
+     */
+    void string(size_t column, std::string_view value) {
+        (void)column;
+        (void)value;
+    }
+
+    /**
+     * @param column Index of the field.
+     * @param value Value of a number.
+     */
+    void number(size_t column, double value) {
+        (void)column;
+        (void)value;
+    }
+
+    /**
+     * @param column Index of the field.
+     * @param value Value of an integer.
+     * This is only called if `ReadOptions::detect_integers = true`,
+     * and only until the field contains its first non-integer number, after which all values are reported via `number()`.
+     */
+    void integer(size_t column, int64_t value) {
+        (void)column;
+        (void)value;
+    }
+
+    /**
+     * @param column Index of the field.
+     * @param value Value of a boolean.
+     */
+    void boolean(size_t column, bool value) {
+        (void)column;
+        (void)value;
+    }
+
+    /**
+     * @param column Index of the field.
+     * @param value Value of a complex number.
+     */
+    void complex(size_t column, std::complex<double> value) {
+        (void)column;
+        (void)value;
+    }
+
+    /**
+     * @param column Index of the field.
+     * This is called for each missing value.
+     */
+    void missing(size_t column) {
+        (void)column;
+    }
+
+    /**
+     * @param line Index of the record, where the header is line 0.
+     * This is called after all fields of a record have been reported and the number of fields has been checked.
+     */
+    void record(size_t line) {
+        (void)line;
+    }
+};
+
+/**
+ * @cond
+ */
+namespace internals {
+
+// Implements the same methods as Parser::ContentsStore, but forwards each
+// value to the handler. Only the type of each field is retained, so that we
+// can apply the same type checks as the Parser in constant memory.
+template<class Handler>
+struct VisitorStore {
+    VisitorStore(Handler& handler, size_t nfields, bool detect_integers) : handler(handler), types(nfields, UNKNOWN), detect_integers(detect_integers) {}
+
+    size_t num_fields() const {
+        return types.size();
+    }
+
+    void check_column_type(Type observed, size_t column, size_t line) {
+        if (column >= types.size()) {
+            throw std::runtime_error("more fields on line " + std::to_string(line + 1) + " than expected from the header");
+        }
+
+        auto& expected = types[column];
+        if (expected == observed) {
+            return;
+        } else if (expected == UNKNOWN) {
+            expected = observed;
+        } else if (expected == INTEGER && observed == NUMBER && detect_integers) {
+            expected = NUMBER;
+        } else {
+            throw std::runtime_error("previous and current types do not match up");
+        }
+    }
+
+    ValidationLevel validation(size_t) const {
+        return ValidationLevel::FULL;
+    }
+
+    template<class Input>
+    void add_string(Input& input, size_t column, size_t line) {
+        check_column_type(STRING, column, line);
+        if constexpr(std::is_same<Input, BufferInput>::value) {
+            bool escaped;
+            handler.string(column, to_string_view(input, column, line, scratch, escaped));
+        } else {
+            scratch.clear();
+            to_string(input, column, line, scratch);
+            handler.string(column, std::string_view(scratch));
+        }
+    }
+
+    template<typename T, Type tt>
+    void add_value(size_t column, size_t line, T value) {
+        check_column_type(tt, column, line);
+        if constexpr(tt == NUMBER) {
+            handler.number(column, value);
+        } else if constexpr(tt == BOOLEAN) {
+            handler.boolean(column, value);
+        } else {
+            handler.complex(column, value);
+        }
+    }
+
+    void add_integer(size_t column, size_t line, int64_t value) {
+        if (column < types.size() && types[column] == NUMBER) { // i.e., after promotion.
+            handler.number(column, value);
+        } else {
+            check_column_type(INTEGER, column, line);
+            handler.integer(column, value);
+        }
+    }
+
+    void add_missing(size_t column, size_t line) {
+        if (column >= types.size()) {
+            throw std::runtime_error("more fields on line " + std::to_string(line + 1) + " than expected from the header");
+        }
+        handler.missing(column);
+    }
+
+    void add_skipped(size_t, size_t) {}
+
+    void finish_record(size_t line) {
+        handler.record(line);
+    }
+
+    void finish() {}
+
+    Handler& handler;
+    std::vector<Type> types;
+    bool detect_integers;
+    std::string scratch;
+};
+
+template<class Input, class Handler>
+void visit_input(Input& input, Handler& handler, const ReadOptions& options) {
+    Parser parser(NULL);
+    parser.set_detect_integers(options.detect_integers);
+    parser.set_skip_records(options.skip_records);
+    parser.set_max_records(options.max_records);
+
+    Contents info;
+    bool remaining = parser.parse_header(input, info);
+    handler.header(info.names);
+
+    if (remaining) {
+        VisitorStore<Handler> store(handler, info.names.size(), options.detect_integers);
+        size_t line = 1;
+        parser.parse_limited(input, store, line);
+    }
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @tparam Handler A class that implements the same methods as `Visitor`.
+ *
+ * @param buffer Pointer to an in-memory buffer containing the contents of a CSV file.
+ * @param n Length of the buffer.
+ * @param handler Instance of a `Handler`, to be called for each event in the file.
+ * @param options Reading options.
+ * Only `ReadOptions::detect_integers`, `ReadOptions::skip_records` and `ReadOptions::max_records` are used here.
+ *
+ * This performs the same validation as `read_buffer()`, but each value is passed to `handler` instead of being stored.
+ * Strings are passed as views into `buffer` where possible.
+ */
+template<class Handler>
+void visit_buffer(const char* buffer, size_t n, Handler& handler, const ReadOptions& options) {
+    BufferInput input(buffer, buffer + n);
+    internals::visit_input(input, handler, options);
+}
+
+/**
+ * @tparam Reader A reader class that implements the same methods as `bytme::Reader`.
+ * @tparam Handler A class that implements the same methods as `Visitor`.
+ *
+ * @param reader Instance of a `Reader` class, containing the data stream for a CSV file.
+ * @param handler Instance of a `Handler`, to be called for each event in the file.
+ * @param options Reading options.
+ * Only `ReadOptions::parallel`, `ReadOptions::buffer_size`, `ReadOptions::prefetch_depth`, `ReadOptions::detect_integers`, `ReadOptions::skip_records` and `ReadOptions::max_records` are used here.
+ *
+ * This performs the same validation as `read()`, but each value is passed to `handler` instead of being stored.
+ * Memory usage is constant with respect to the number of records in the file,
+ * except for readers with contiguous storage, which are parsed directly as in `read()`.
+ */
+template<class Reader, class Handler>
+void visit(Reader& reader, Handler& handler, const ReadOptions& options) {
+    if constexpr(internals::is_contiguous<Reader>::value) {
+        visit_buffer(reinterpret_cast<const char*>(reader.data()), reader.size(), handler, options);
+    } else {
+        internals::with_buffered_input(&reader, options.parallel, options.buffer_size, options.prefetch_depth, nullptr, [&](auto& input) -> void {
+            internals::visit_input(input, handler, options);
+        });
+    }
+}
+
+/**
+ * @tparam Handler A class that implements the same methods as `Visitor`.
+ *
+ * @param path Path to a (possibly Gzipped) CSV file.
+ * @param handler Instance of a `Handler`, to be called for each event in the file.
+ * @param options Reading options, see the `visit()` overload for details.
+ * Uncompressed files are memory-mapped if `ReadOptions::memory_map = true`.
+ *
+ * Gzip support requires linking to the Zlib library.
+ */
+template<class Handler>
+void visit_file(const char* path, Handler& handler, const ReadOptions& options) {
+#if __has_include("zlib.h")
+    bool gzipped = byteme::is_gzip(path);
+#else
+    bool gzipped = false;
+#endif
+
+#ifdef COMSERVATORY_HAS_MMAP
+    if (options.memory_map && !gzipped) {
+        MappedFile mapped(path, options.huge_pages);
+        visit_buffer(mapped.data(), mapped.size(), handler, options);
+        return;
+    }
+#endif
+
+#if __has_include("zlib.h")
+    if (gzipped) {
+        byteme::GzipFileReader reader(path, {});
+        visit(reader, handler, options);
+        return;
+    }
+#else
+    (void)gzipped;
+#endif
+
+    byteme::RawFileReader reader(path, {});
+    visit(reader, handler, options);
+}
+
+/**
+ * @tparam Handler A class that implements the same methods as `Visitor`.
+ *
+ * @param path Path to a (possibly Gzipped) CSV file.
+ * @param handler Instance of a `Handler`, to be called for each event in the file.
+ * @param options Reading options, see the `visit()` overload for details.
+ *
+ * Gzip support requires linking to the Zlib library.
+ */
+template<class Handler>
+void visit_file(const std::string& path, Handler& handler, const ReadOptions& options) {
+    visit_file(path.c_str(), handler, options);
+}
+
+}
+
+#endif
@@ -0,0 +1,511 @@
+#ifndef COMSERVATORY_WRITE_HPP
+#define COMSERVATORY_WRITE_HPP
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <complex>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <charconv>
+#include <memory>
+#include <stdexcept>
+#include <algorithm>
+
+#include "Type.hpp"
+#include "Field.hpp"
+#include "Parser.hpp"
+#include "parallelize.hpp"
+#include "BlockedGzipWriter.hpp"
+
+/**
+ * @file write.hpp
+ *
+ * @brief Write a CSV file.
+ */
+
+namespace comservatory {
+
+/**
+ * @brief Options for writing the contents of a CSV file.
+ */
+struct WriteOptions {
+    /**
+     * Number of threads to use for formatting the records.
+     * Records are formatted in chunks on separate threads, and the chunks are written in their original order.
+     */
+    int num_threads = 1;
+
+    /**
+     * Number of records in each chunk.
+     * Larger values reduce the overhead of parallelization but increase memory usage, as up to `num_threads` chunks are formatted in memory at any time.
+     */
+    size_t chunk_records = 10000;
+
+    /**
+     * Whether `write_file()` should compress the output in the blocked Gzip format, see `BlockedGzipWriter`.
+     * Compression is performed with `num_threads` threads.
+     * Only available if Zlib is available.
+     */
+    bool gzip = false;
+
+    /**
+     * Compression level, from 0 to 9.
+     * Only used if `gzip = true`.
+     */
+    int compression_level = 6;
+};
+
+/**
+ * @cond
+ */
+namespace internals {
+
+inline void format_string(std::string_view x, std::string& output) {
+    output += '"';
+
+    // Appending the spans between quotes in bulk.
+    const char* ptr = x.data();
+    const char* end = ptr + x.size();
+    while (ptr < end) {
+        auto quote = static_cast<const char*>(std::memchr(ptr, '"', end - ptr));
+        if (quote == NULL) {
+            output.append(ptr, end);
+            break;
+        }
+        output.append(ptr, quote + 1);
+        output += '"';
+        ptr = quote + 1;
+    }
+
+    output += '"';
+}
+
+template<typename T>
+void format_chars(T x, std::string& output) {
+    char buffer[32];
+    auto res = std::to_chars(buffer, buffer + sizeof(buffer), x); // shortest round-trip representation for doubles.
+    output.append(buffer, res.ptr);
+}
+
+inline void format_number(double x, std::string& output) {
+    if (std::isnan(x)) {
+        output += "nan";
+    } else if (std::isinf(x)) {
+        output += (x > 0 ? "inf" : "-inf");
+    } else {
+        format_chars(x, output);
+    }
+}
+
+inline void format_complex(const std::complex<double>& x, std::string& output) {
+    if (!std::isfinite(x.real()) || !std::isfinite(x.imag())) {
+        throw std::runtime_error("complex numbers with non-finite parts cannot be written");
+    }
+    format_chars(x.real(), output);
+    if (!std::signbit(x.imag())) {
+        output += '+';
+    }
+    format_chars(x.imag(), output);
+    output += 'i';
+}
+
+inline void format_value(double x, std::string& output) {
+    format_number(x, output);
+}
+
+inline void format_value(int64_t x, std::string& output) {
+    format_chars(x, output);
+}
+
+inline void format_value(bool x, std::string& output) {
+    output += (x ? "true" : "false");
+}
+
+inline void format_value(const std::complex<double>& x, std::string& output) {
+    format_complex(x, output);
+}
+
+inline void format_value(std::string_view x, std::string& output) {
+    format_string(x, output);
+}
+
+// Formats the values of a field in consecutive records. Each chunk gets its
+// own instance, as the cursor for the missing values is not thread-safe.
+struct ColumnFormatter {
+    virtual ~ColumnFormatter() = default;
+
+    // Moves to record 'i', which should be followed by format() for records
+    // 'i', 'i + 1', and so on.
+    virtual void seek(size_t i) = 0;
+
+    virtual void format(size_t i, std::string& output) = 0;
+};
+
+// For fields that store the sorted indices of the missing values.
+template<class Field_, typename Get_>
+struct SortedMissingFormatter : public ColumnFormatter {
+    SortedMissingFormatter(const Field_* field, Get_ get) : field(field), get(std::move(get)) {}
+
+    void seek(size_t i) {
+        const auto& missing = field->missing;
+        mIt = std::lower_bound(missing.begin(), missing.end(), i);
+    }
+
+    void format(size_t i, std::string& output) {
+        if (mIt != field->missing.end() && *mIt == i) {
+            output += "NA";
+            ++mIt;
+        } else {
+            format_value(get(field, i), output);
+        }
+    }
+
+    const Field_* field;
+    Get_ get;
+    std::vector<size_t>::const_iterator mIt;
+};
+
+template<class Field_, typename Get_>
+std::unique_ptr<ColumnFormatter> sorted_missing_formatter(const Field_* field, Get_ get) {
+    return std::unique_ptr<ColumnFormatter>(new SortedMissingFormatter<Field_, Get_>(field, std::move(get)));
+}
+
+template<typename T, Type tt>
+struct MaskedFormatter : public ColumnFormatter {
+    MaskedFormatter(const MaskedField<T, tt>* field) : field(field) {}
+
+    void seek(size_t) {}
+
+    void format(size_t i, std::string& output) {
+        if (field->is_missing(i)) {
+            output += "NA";
+        } else {
+            format_value(field->values[i - field->leading], output);
+        }
+    }
+
+    const MaskedField<T, tt>* field;
+};
+
+struct MissingFormatter : public ColumnFormatter {
+    void seek(size_t) {}
+
+    void format(size_t, std::string& output) {
+        output += "NA";
+    }
+};
+
+template<typename T, Type tt>
+std::unique_ptr<ColumnFormatter> typed_formatter(const Field* field) {
+    if (auto fptr = dynamic_cast<const FilledField<T, tt>*>(field)) {
+        return sorted_missing_formatter(fptr, [](const FilledField<T, tt>* f, size_t i) -> T { return f->values[i]; });
+    }
+    if (auto mptr = dynamic_cast<const MaskedField<T, tt>*>(field)) {
+        return std::unique_ptr<ColumnFormatter>(new MaskedFormatter<T, tt>(mptr));
+    }
+    return nullptr;
+}
+
+inline std::unique_ptr<ColumnFormatter> create_formatter(const Field* field, const std::string& name) {
+    if (!field->filled()) {
+        throw std::runtime_error("field '" + name + "' does not contain any values to write");
+    }
+
+    std::unique_ptr<ColumnFormatter> output;
+    switch (field->type()) {
+        case UNKNOWN:
+            output.reset(new MissingFormatter);
+            break;
+        case NUMBER:
+            output = typed_formatter<double, NUMBER>(field);
+            break;
+        case INTEGER:
+            output = typed_formatter<int64_t, INTEGER>(field);
+            break;
+        case BOOLEAN:
+            output = typed_formatter<bool, BOOLEAN>(field);
+            break;
+        case COMPLEX:
+            output = typed_formatter<std::complex<double>, COMPLEX>(field);
+            break;
+        case STRING:
+            if (auto aptr = dynamic_cast<const ArenaStringField*>(field)) {
+                output = sorted_missing_formatter(aptr, [](const ArenaStringField* f, size_t i) -> std::string_view { return f->get(i); });
+            } else if (auto vptr = dynamic_cast<const StringViewField*>(field)) {
+                output = sorted_missing_formatter(vptr, [](const StringViewField* f, size_t i) -> std::string_view { return f->values[i]; });
+            } else if (auto sptr = dynamic_cast<const FilledStringField*>(field)) {
+                output = sorted_missing_formatter(sptr, [](const FilledStringField* f, size_t i) -> std::string_view { return f->values[i]; });
+            } else {
+                output = typed_formatter<std::string, STRING>(field);
+            }
+            break;
+    }
+
+    if (!output) {
+        throw std::runtime_error("field '" + name + "' has an unsupported class for writing");
+    }
+    return output;
+}
+
+template<class Writer>
+void write_header(const std::vector<std::string>& names, Writer& writer) {
+    std::string header;
+    for (size_t c = 0, ncols = names.size(); c < ncols; ++c) {
+        if (c) {
+            header += ',';
+        }
+        format_string(names[c], header);
+    }
+    header += '\n';
+    writer.write(header.data(), header.size());
+}
+
+// Formats and writes the records of 'contents', in chunks of records that
+// are formatted in parallel.
+template<class Writer>
+void write_records(const Contents& contents, Writer& writer, const WriteOptions& options) {
+    size_t ncols = contents.num_fields();
+    size_t nrecords = contents.num_records();
+    if (contents.fields.size() != ncols) {
+        throw std::runtime_error("number of fields and names should be the same");
+    }
+    for (size_t c = 0; c < ncols; ++c) {
+        if (contents.fields[c]->size() != nrecords) {
+            throw std::runtime_error("all fields should have the same number of records");
+        }
+    }
+
+    if (ncols == 0) {
+        // Each record is represented by an empty line.
+        std::string empty(std::min(nrecords, static_cast<size_t>(65536)), '\n');
+        for (size_t start = 0; start < nrecords; start += empty.size()) {
+            writer.write(empty.data(), std::min(empty.size(), nrecords - start));
+        }
+        return;
+    }
+
+    // Checking that all fields can be written before we start.
+    for (size_t c = 0; c < ncols; ++c) {
+        create_formatter(contents.fields[c].get(), contents.names[c]);
+    }
+
+    int nthreads = std::max(options.num_threads, 1);
+    size_t chunk_size = std::max(options.chunk_records, static_cast<size_t>(1));
+    size_t nchunks = (nrecords + chunk_size - 1) / chunk_size;
+    std::vector<std::string> buffers(std::min(nchunks, static_cast<size_t>(nthreads)));
+
+    for (size_t first = 0; first < nchunks; first += buffers.size()) {
+        size_t nbatch = std::min(buffers.size(), nchunks - first);
+        parallelize(nbatch, nthreads, [&](size_t b) -> void {
+            size_t start = (first + b) * chunk_size;
+            size_t end = std::min(nrecords, start + chunk_size);
+
+            std::vector<std::unique_ptr<ColumnFormatter> > formatters;
+            formatters.reserve(ncols);
+            for (size_t c = 0; c < ncols; ++c) {
+                formatters.push_back(create_formatter(contents.fields[c].get(), contents.names[c]));
+                formatters.back()->seek(start);
+            }
+
+            auto& output = buffers[b];
+            output.clear();
+            for (size_t r = start; r < end; ++r) {
+                for (size_t c = 0; c < ncols; ++c) {
+                    if (c) {
+                        output += ',';
+                    }
+                    formatters[c]->format(r, output);
+                }
+                output += '\n';
+            }
+        });
+
+        for (size_t b = 0; b < nbatch; ++b) {
+            writer.write(buffers[b].data(), buffers[b].size());
+        }
+    }
+}
+
+// Writes to a file with the same interface as BlockedGzipWriter.
+class FileWriter {
+public:
+    FileWriter(const char* path) {
+        handle = std::fopen(path, "wb");
+        if (handle == NULL) {
+            throw std::runtime_error("failed to open file at '" + std::string(path) + "'");
+        }
+    }
+
+    ~FileWriter() {
+        if (handle) {
+            std::fclose(handle);
+        }
+    }
+
+    FileWriter(const FileWriter&) = delete;
+    FileWriter& operator=(const FileWriter&) = delete;
+
+    void write(const char* data, size_t n) {
+        if (std::fwrite(data, 1, n, handle) != n) {
+            throw std::runtime_error("failed to write to file");
+        }
+    }
+
+    void finish() {
+        bool failed = (std::fclose(handle) != 0);
+        handle = NULL;
+        if (failed) {
+            throw std::runtime_error("failed to close file");
+        }
+    }
+
+private:
+    std::FILE* handle;
+};
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * @tparam Writer A writer class with a `write(const char* data, size_t n)` method, e.g., `BlockedGzipWriter`.
+ *
+ * @param contents `Contents` of a CSV file.
+ * All fields should have the same number of records and be instances of the default `Field` classes, i.e., those created by `DefaultFieldCreator<false>`.
+ * @param writer Instance of a `Writer` class, to receive the formatted contents.
+ * @param options Writing options.
+ *
+ * Numbers are formatted with the shortest representation that round-trips to the same double-precision value.
+ * Missing values are written as `NA`, and non-finite numbers are written as `nan`, `inf` or `-inf`;
+ * however, an error is raised for complex numbers with non-finite parts, which cannot be represented in the comservatory format.
+ * An error is also raised for dummy fields.
+ */
+template<class Writer>
+void write(const Contents& contents, Writer& writer, const WriteOptions& options) {
+    internals::write_header(contents.names, writer);
+    internals::write_records(contents, writer, options);
+}
+
+/**
+ * @param contents `Contents` of a CSV file, see `write()` for details.
+ * @param options Writing options.
+ *
+ * @return String containing the contents of the CSV file.
+ */
+inline std::string write_buffer(const Contents& contents, const WriteOptions& options) {
+    struct StringWriter {
+        void write(const char* data, size_t n) {
+            output.append(data, n);
+        }
+        std::string output;
+    };
+
+    StringWriter writer;
+    write(contents, writer, options);
+    return std::move(writer.output);
+}
+
+/**
+ * @param contents `Contents` of a CSV file, see `write()` for details.
+ * @param path Path to the output file.
+ * @param options Writing options.
+ *
+ * If `WriteOptions::gzip = true`, the file is compressed with `BlockedGzipWriter`.
+ */
+inline void write_file(const Contents& contents, const char* path, const WriteOptions& options) {
+    if (options.gzip) {
+#if __has_include("zlib.h")
+        BlockedGzipWriter writer(path, options.num_threads, options.compression_level);
+        write(contents, writer, options);
+        writer.finish();
+        return;
+#else
+        throw std::runtime_error("Gzip compression requires Zlib");
+#endif
+    }
+
+    internals::FileWriter writer(path);
+    write(contents, writer, options);
+    writer.finish();
+}
+
+/**
+ * @param contents `Contents` of a CSV file, see `write()` for details.
+ * @param path Path to the output file.
+ * @param options Writing options.
+ */
+inline void write_file(const Contents& contents, const std::string& path, const WriteOptions& options) {
+    write_file(contents, path.c_str(), options);
+}
+
+/**
+ * @param contents `Contents` of a CSV file, see `write()` for details.
+ * @param path Path to the output file.
+ */
+inline void write_file(const Contents& contents, const std::string& path) {
+    write_file(contents, path.c_str(), WriteOptions());
+}
+
+/**
+ * @brief Write a CSV file in batches of records.
+ *
+ * This is the counterpart to `BatchReader`, where each call to `write()` appends the records of a batch to the file.
+ * Memory usage is limited to that of a single batch, so that large files can be streamed from a producer.
+ *
+ * @tparam Writer A writer class with a `write(const char* data, size_t n)` method, see `write()`.
+ */
+template<class Writer>
+class BatchWriter {
+public:
+    /**
+     * @param writer Instance of a `Writer` class, to receive the formatted contents.
+     * This should outlive the `BatchWriter`.
+     * @param names Names of the fields.
+     * The header is written upon construction.
+     * @param options Writing options.
+     */
+    BatchWriter(Writer& writer, std::vector<std::string> names, const WriteOptions& options) :
+        writer(writer), names(std::move(names)), types(this->names.size(), UNKNOWN), options(options)
+    {
+        internals::write_header(this->names, writer);
+    }
+
+    /**
+     * @param batch `Contents` containing the next batch of records, see `write()` for details.
+     * The names should be the same as those used in the constructor.
+     * The type of each field should be consistent with that in previous batches, ignoring batches where the field is `UNKNOWN`.
+     */
+    void write(const Contents& batch) {
+        if (batch.names != names) {
+            throw std::runtime_error("names in the batch should be the same as those in the header");
+        }
+
+        // Checking that the types are consistent, as the file would be invalid otherwise.
+        for (size_t c = 0, ncols = names.size(); c < ncols; ++c) {
+            auto observed = batch.fields[c]->type();
+            if (observed == UNKNOWN) {
+                continue;
+            } else if (types[c] == UNKNOWN) {
+                types[c] = observed;
+            } else if (types[c] != observed) {
+                throw std::runtime_error("type of field '" + names[c] + "' (" + type_to_name(observed) + ") differs from previous batches (" + type_to_name(types[c]) + ")");
+            }
+        }
+
+        internals::write_records(batch, writer, options);
+    }
+
+private:
+    Writer& writer;
+    std::vector<std::string> names;
+    std::vector<Type> types;
+    WriteOptions options;
+};
+
+}
+
+#endif
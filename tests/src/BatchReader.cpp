@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "utils.h"
+#include "compare_contents.h"
+#include "byteme/byteme.hpp"
+
+#include <string>
+#include <vector>
+
+TEST(BatchReaderTest, Basic) {
+    std::string x = "\"a\",\"b\",\"c\"\n";
+    for (size_t i = 0; i < 10; ++i) {
+        x += std::to_string(i) + ",\"foo" + std::to_string(i) + "\"," + (i % 2 ? "true" : "NA") + "\n";
+    }
+
+    byteme::RawBufferReader ref_reader(raw_bytes(x), x.size());
+    auto ref = load_simple(ref_reader);
+
+    byteme::RawBufferReader reader(raw_bytes(x), x.size());
+    comservatory::BatchReader<byteme::RawBufferReader> batches(reader, 4, comservatory::ReadOptions());
+    EXPECT_EQ(batches.names(), ref.names);
+
+    comservatory::Contents batch;
+    std::vector<size_t> sizes;
+    std::vector<double> numbers;
+    std::vector<std::string> strings;
+    comservatory::Field* first = NULL;
+    while (batches.next(batch)) {
+        sizes.push_back(batch.num_records());
+        EXPECT_EQ(batch.names, ref.names);
+
+        auto nptr = static_cast<const comservatory::FilledNumberField*>(batch.fields[0].get());
+        numbers.insert(numbers.end(), nptr->values.begin(), nptr->values.end());
+        auto sptr = static_cast<const comservatory::FilledStringField*>(batch.fields[1].get());
+        strings.insert(strings.end(), sptr->values.begin(), sptr->values.end());
+
+        // Fields are reused across batches.
+        if (first) {
+            EXPECT_EQ(first, batch.fields[0].get());
+        } else {
+            first = batch.fields[0].get();
+        }
+    }
+
+    EXPECT_EQ(sizes, (std::vector<size_t>{ 4, 4, 2 }));
+    EXPECT_EQ(numbers, static_cast<const comservatory::FilledNumberField*>(ref.fields[0].get())->values);
+    EXPECT_EQ(strings, static_cast<const comservatory::FilledStringField*>(ref.fields[1].get())->values);
+    EXPECT_FALSE(batches.next(batch));
+
+    // Works with a batch size that is larger than the file.
+    byteme::RawBufferReader reader2(raw_bytes(x), x.size());
+    comservatory::BatchReader<byteme::RawBufferReader> batches2(reader2, 100, comservatory::ReadOptions());
+    comservatory::Contents batch2;
+    EXPECT_TRUE(batches2.next(batch2));
+    compare_contents(ref, batch2);
+    EXPECT_FALSE(batches2.next(batch2));
+}
+
+TEST(BatchReaderTest, DelayedResolution) {
+    std::string x = "\"a\",\"b\"\n1,NA\n2,NA\n3,NA\n4,\"foo\"\n5,NA\n";
+    byteme::RawBufferReader reader(raw_bytes(x), x.size());
+    comservatory::BatchReader<byteme::RawBufferReader> batches(reader, 2, comservatory::ReadOptions());
+
+    comservatory::Contents batch;
+    EXPECT_TRUE(batches.next(batch));
+    EXPECT_EQ(batch.fields[1]->type(), comservatory::UNKNOWN);
+    EXPECT_EQ(batch.fields[1]->size(), 2);
+
+    EXPECT_TRUE(batches.next(batch));
+    EXPECT_EQ(batch.fields[1]->type(), comservatory::STRING);
+    auto sptr = static_cast<const comservatory::FilledStringField*>(batch.fields[1].get());
+    EXPECT_EQ(sptr->values, (std::vector<std::string>{ "", "foo" }));
+    EXPECT_EQ(sptr->missing, std::vector<size_t>{ 0 });
+
+    // Type is carried over to the next batch.
+    EXPECT_TRUE(batches.next(batch));
+    EXPECT_EQ(batch.fields[1]->type(), comservatory::STRING);
+    EXPECT_EQ(batch.fields[1]->size(), 1);
+    EXPECT_FALSE(batches.next(batch));
+}
+
+TEST(BatchReaderTest, Errors) {
+    // Type mismatches are detected across batches.
+    {
+        std::string x = "\"a\"\n1\n2\n\"foo\"\n";
+        byteme::RawBufferReader reader(raw_bytes(x), x.size());
+        comservatory::BatchReader<byteme::RawBufferReader> batches(reader, 2, comservatory::ReadOptions());
+        comservatory::Contents batch;
+        EXPECT_TRUE(batches.next(batch));
+        EXPECT_ANY_THROW({
+            try {
+                batches.next(batch);
+            } catch (std::exception& e) {
+                EXPECT_THAT(e.what(), ::testing::HasSubstr("do not match"));
+                throw;
+            }
+        });
+    }
+
+    // Line numbers are preserved across batches.
+    {
+        std::string x = "\"a\"\n1\n2\n3\n4,5\n";
+        byteme::RawBufferReader reader(raw_bytes(x), x.size());
+        comservatory::BatchReader<byteme::RawBufferReader> batches(reader, 2, comservatory::ReadOptions());
+        comservatory::Contents batch;
+        EXPECT_TRUE(batches.next(batch));
+        EXPECT_ANY_THROW({
+            try {
+                batches.next(batch);
+            } catch (std::exception& e) {
+                EXPECT_THAT(e.what(), ::testing::HasSubstr("more fields on line 5"));
+                throw;
+            }
+        });
+    }
+
+    {
+        std::string x = "\"a\"\n";
+        byteme::RawBufferReader reader(raw_bytes(x), x.size());
+        EXPECT_ANY_THROW({
+            try {
+                comservatory::BatchReader<byteme::RawBufferReader> batches(reader, 0, comservatory::ReadOptions());
+            } catch (std::exception& e) {
+                EXPECT_THAT(e.what(), ::testing::HasSubstr("positive"));
+                throw;
+            }
+        });
+
+        comservatory::BatchReader<byteme::RawBufferReader> batches(reader, 10, comservatory::ReadOptions());
+        comservatory::Contents batch;
+        EXPECT_FALSE(batches.next(batch)); // header-only file.
+    }
+}
@@ -36,6 +36,217 @@ TEST(FieldTest, DummyString) {
     EXPECT_EQ(x.size(), 2);
 }
 
+TEST(FieldTest, ArenaString) {
+    comservatory::ArenaStringField x(2);
+    EXPECT_EQ(x.size(), 2);
+    EXPECT_EQ(x.type(), comservatory::STRING);
+
+    x.push_back("asda");
+    EXPECT_EQ(x.size(), 3);
+    EXPECT_EQ(x.get(2), "asda");
+
+    auto buffer = x.start_append();
+    ASSERT_TRUE(buffer != NULL);
+    buffer->push_back('z');
+    x.finish_append();
+    EXPECT_EQ(x.get(3), "z");
+
+    x.add_missing();
+    EXPECT_EQ(x.size(), 5);
+    EXPECT_EQ(x.get(4), "");
+    EXPECT_EQ(x.missing, std::vector<size_t>({ 0, 1, 4 }));
+
+    comservatory::ArenaStringField y(1);
+    y.push_back("foo");
+    x.append(y);
+    EXPECT_EQ(x.size(), 7);
+    EXPECT_EQ(x.get(6), "foo");
+    EXPECT_EQ(x.get(2), "asda");
+    EXPECT_EQ(x.missing, std::vector<size_t>({ 0, 1, 4, 5 }));
+
+    // Default string fields don't support direct appends.
+    comservatory::FilledStringField z;
+    EXPECT_TRUE(z.start_append() == NULL);
+}
+
+TEST(FieldTest, StringView) {
+    comservatory::StringViewField x(1);
+    EXPECT_EQ(x.size(), 1);
+    EXPECT_TRUE(x.use_views());
+
+    std::string persistent = "foobar";
+    x.push_back_view(std::string_view(persistent), true);
+    EXPECT_EQ(x.values[1].data(), persistent.data());
+
+    {
+        std::string temporary = "whee";
+        x.push_back_view(std::string_view(temporary), false);
+        x.push_back(std::string(5000, 'a')); // larger than a block.
+        x.push_back("");
+    }
+    x.add_missing();
+    EXPECT_EQ(x.size(), 6);
+    EXPECT_EQ(x.values[2], "whee");
+    EXPECT_EQ(x.values[3], std::string(5000, 'a'));
+    EXPECT_EQ(x.values[4], "");
+    EXPECT_EQ(x.missing, std::vector<size_t>({ 0, 5 }));
+
+    comservatory::StringViewField y;
+    y.push_back("stuff");
+    y.add_missing();
+    x.append(y);
+    EXPECT_EQ(x.size(), 8);
+    EXPECT_EQ(x.values[6], "stuff");
+    EXPECT_EQ(x.missing, std::vector<size_t>({ 0, 5, 7 }));
+
+    // Default string fields just copy the views.
+    comservatory::FilledStringField z;
+    EXPECT_FALSE(z.use_views());
+    z.push_back_view(std::string_view(persistent), true);
+    EXPECT_EQ(z.values[0], "foobar");
+}
+
+TEST(FieldTest, Masked) {
+    comservatory::MaskedNumberField x(100);
+    EXPECT_EQ(x.size(), 100);
+    EXPECT_TRUE(x.values.empty());
+    EXPECT_TRUE(x.validity.empty());
+
+    x.add_missing();
+    EXPECT_EQ(x.leading, 101);
+
+    x.push_back(1.5);
+    for (size_t i = 0; i < 70; ++i) {
+        x.add_missing();
+    }
+    x.push_back(2.5);
+    EXPECT_EQ(x.size(), 173);
+    EXPECT_EQ(x.values.size(), 72);
+    EXPECT_EQ(x.validity.size(), 2);
+
+    EXPECT_TRUE(x.is_missing(0));
+    EXPECT_TRUE(x.is_missing(100));
+    EXPECT_FALSE(x.is_missing(101));
+    EXPECT_EQ(x.get(101), 1.5);
+    EXPECT_TRUE(x.is_missing(102));
+    EXPECT_TRUE(x.is_missing(171));
+    EXPECT_FALSE(x.is_missing(172));
+    EXPECT_EQ(x.get(172), 2.5);
+    EXPECT_EQ(x.get(0), 0);
+
+    comservatory::MaskedNumberField y(2);
+    y.push_back(3.5);
+    x.append(y);
+    EXPECT_EQ(x.size(), 176);
+    EXPECT_TRUE(x.is_missing(173));
+    EXPECT_TRUE(x.is_missing(174));
+    EXPECT_EQ(x.get(175), 3.5);
+
+    // Appending to an all-missing field just extends the leading run.
+    comservatory::MaskedNumberField z(5);
+    z.append(y);
+    EXPECT_EQ(z.leading, 7);
+    EXPECT_EQ(z.get(7), 3.5);
+}
+
+struct PlainNumberField : public comservatory::NumberField {
+    std::vector<double> values;
+    size_t size() const { return values.size(); }
+    void push_back(double x) { values.push_back(x); }
+    void add_missing() { values.push_back(-1); }
+};
+
+TEST(FieldTest, Batched) {
+    std::vector<double> stuff { 1, 2, 3 };
+
+    comservatory::FilledNumberField x(1);
+    x.push_back_many(stuff.data(), stuff.size());
+    x.add_missing_many(2);
+    x.push_back(4);
+    EXPECT_EQ(x.values, std::vector<double>({ 0, 1, 2, 3, 0, 0, 4 }));
+    EXPECT_EQ(x.missing, std::vector<size_t>({ 0, 4, 5 }));
+
+    comservatory::DummyNumberField d(1);
+    d.push_back_many(stuff.data(), stuff.size());
+    d.add_missing_many(2);
+    EXPECT_EQ(d.size(), 6);
+
+    comservatory::UnknownField u;
+    u.add_missing_many(5);
+    EXPECT_EQ(u.size(), 5);
+
+    comservatory::MaskedNumberField m(1);
+    m.add_missing_many(2);
+    EXPECT_EQ(m.leading, 3);
+    m.push_back_many(stuff.data(), stuff.size());
+    m.add_missing_many(100);
+    m.push_back(4);
+    EXPECT_EQ(m.size(), 107);
+    EXPECT_EQ(m.validity.size(), 2);
+    EXPECT_FALSE(m.is_missing(5));
+    EXPECT_TRUE(m.is_missing(6));
+    EXPECT_TRUE(m.is_missing(105));
+    EXPECT_EQ(m.get(106), 4);
+
+    comservatory::ArenaStringField a;
+    a.push_back("foo");
+    a.add_missing_many(2);
+    a.push_back("bar");
+    EXPECT_EQ(a.size(), 4);
+    EXPECT_EQ(a.missing, std::vector<size_t>({ 1, 2 }));
+    EXPECT_EQ(a.get(3), "bar");
+
+    comservatory::StringViewField v;
+    v.add_missing_many(2);
+    v.push_back("foo");
+    EXPECT_EQ(v.size(), 3);
+    EXPECT_EQ(v.missing, std::vector<size_t>({ 0, 1 }));
+
+    // Default implementations for custom fields.
+    PlainNumberField p;
+    p.push_back_many(stuff.data(), stuff.size());
+    p.add_missing_many(2);
+    EXPECT_EQ(p.values, std::vector<double>({ 1, 2, 3, -1, -1 }));
+}
+
+TEST(FieldTest, Clear) {
+    comservatory::UnknownField u;
+    u.add_missing_many(5);
+    EXPECT_TRUE(u.clear());
+    EXPECT_EQ(u.size(), 0);
+
+    comservatory::FilledNumberField f;
+    f.push_back(1);
+    f.add_missing();
+    EXPECT_TRUE(f.clear());
+    EXPECT_EQ(f.size(), 0);
+    EXPECT_TRUE(f.missing.empty());
+
+    comservatory::DummyNumberField d(5);
+    EXPECT_TRUE(d.clear());
+    EXPECT_EQ(d.size(), 0);
+
+    comservatory::MaskedNumberField m(2);
+    m.push_back(1);
+    m.add_missing();
+    EXPECT_TRUE(m.clear());
+    EXPECT_EQ(m.size(), 0);
+    m.push_back(2);
+    EXPECT_FALSE(m.is_missing(0));
+
+    comservatory::ArenaStringField a(1);
+    a.push_back("foo");
+    EXPECT_TRUE(a.clear());
+    EXPECT_EQ(a.size(), 0);
+    a.push_back("bar");
+    EXPECT_EQ(a.get(0), "bar");
+    EXPECT_TRUE(a.missing.empty());
+
+    // Not supported by default.
+    comservatory::StringViewField v;
+    EXPECT_FALSE(v.clear());
+}
+
 TEST(FieldTest, FilledNumber) {
     comservatory::FilledNumberField x;
 
@@ -218,10 +429,49 @@ TEST(FieldTest, Creator) {
     }
 }
 
+TEST(FieldTest, Promote) {
+    comservatory::DefaultFieldCreator<false> fun;
+
+    {
+        std::unique_ptr<comservatory::Field> ptr(fun.create(comservatory::INTEGER, 2, false));
+        EXPECT_EQ(ptr->type(), comservatory::INTEGER);
+        EXPECT_TRUE(ptr->filled());
+        static_cast<comservatory::IntegerField*>(ptr.get())->push_back(9007199254740993);
+
+        std::unique_ptr<comservatory::Field> promoted(fun.promote(ptr.get(), comservatory::NUMBER));
+        EXPECT_EQ(promoted->type(), comservatory::NUMBER);
+        auto nptr = static_cast<comservatory::FilledNumberField*>(promoted.get());
+        EXPECT_EQ(nptr->values, std::vector<double>({ 0, 0, 9007199254740992.0 }));
+        EXPECT_EQ(nptr->missing, std::vector<size_t>({ 0, 1 }));
+    }
+
+    {
+        std::unique_ptr<comservatory::Field> ptr(fun.create(comservatory::INTEGER, 3, true));
+        EXPECT_FALSE(ptr->filled());
+        std::unique_ptr<comservatory::Field> promoted(fun.promote(ptr.get(), comservatory::NUMBER));
+        EXPECT_EQ(promoted->type(), comservatory::NUMBER);
+        EXPECT_EQ(promoted->size(), 3);
+        EXPECT_FALSE(promoted->filled());
+    }
+
+    {
+        std::unique_ptr<comservatory::Field> ptr(fun.create(comservatory::STRING, 3, false));
+        EXPECT_ANY_THROW({
+            try {
+                fun.promote(ptr.get(), comservatory::NUMBER);
+            } catch (std::exception& e) {
+                EXPECT_THAT(std::string(e.what()), ::testing::HasSubstr("cannot promote"));
+                throw;
+            }
+        });
+    }
+}
+
 TEST(FieldTest, Names) {
     EXPECT_EQ(comservatory::type_to_name(comservatory::STRING), "STRING");
     EXPECT_EQ(comservatory::type_to_name(comservatory::BOOLEAN), "BOOLEAN");
     EXPECT_EQ(comservatory::type_to_name(comservatory::NUMBER), "NUMBER");
     EXPECT_EQ(comservatory::type_to_name(comservatory::COMPLEX), "COMPLEX");
     EXPECT_EQ(comservatory::type_to_name(comservatory::UNKNOWN), "UNKNOWN");
+    EXPECT_EQ(comservatory::type_to_name(comservatory::INTEGER), "INTEGER");
 }
@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "utils.h"
+#include "compare_contents.h"
+#include "temp_file_path.h"
+
+#include <string>
+#include <vector>
+#include <random>
+#include <fstream>
+
+#if __has_include("zlib.h")
+#include "zlib.h"
+
+class GzipIndexTest : public ::testing::Test {
+protected:
+    // Random-ish contents so that the compressed data has many deflate blocks.
+    static std::string mock_records(size_t n) {
+        std::mt19937_64 rng(n);
+        std::string x = "\"a\",\"b\"\n";
+        for (size_t i = 0; i < n; ++i) {
+            x += std::to_string(i) + ",\"" + std::to_string(rng()) + "\n" + std::to_string(rng() % 1000) + "\"\n";
+        }
+        return x;
+    }
+
+    static void write_gzip(const std::string& path, const std::string& contents, size_t nmembers = 1) {
+        std::ofstream out(path, std::ios::binary);
+        size_t start = 0;
+        for (size_t m = 0; m < nmembers; ++m) {
+            size_t end = contents.size() * (m + 1) / nmembers;
+            std::vector<unsigned char> buffer(compressBound(end - start) + 100);
+            z_stream strm;
+            strm.zalloc = Z_NULL;
+            strm.zfree = Z_NULL;
+            strm.opaque = Z_NULL;
+            deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 31, 8, Z_DEFAULT_STRATEGY);
+            strm.next_in = reinterpret_cast<unsigned char*>(const_cast<char*>(contents.data() + start));
+            strm.avail_in = end - start;
+            strm.next_out = buffer.data();
+            strm.avail_out = buffer.size();
+            deflate(&strm, Z_FINISH);
+            out.write(reinterpret_cast<char*>(buffer.data()), buffer.size() - strm.avail_out);
+            deflateEnd(&strm);
+            start = end;
+        }
+    }
+
+    static std::string read_all(comservatory::GzipIndexedReader& reader) {
+        std::string output;
+        std::vector<unsigned char> buffer(1000);
+        while (1) {
+            size_t got = reader.read(buffer.data(), buffer.size());
+            output.insert(output.end(), buffer.begin(), buffer.begin() + got);
+            if (got < buffer.size()) {
+                break;
+            }
+        }
+        return output;
+    }
+};
+
+TEST_F(GzipIndexTest, Build) {
+    auto x = mock_records(50000);
+    for (size_t nmembers : { 1, 3 }) {
+        auto path = temp_file_path("comservatory-gzindex");
+        write_gzip(path, x, nmembers);
+
+        auto index = comservatory::build_gzip_index(path, 100000);
+        EXPECT_GT(index.checkpoints.size(), 5);
+        EXPECT_EQ(index.size, x.size());
+        EXPECT_EQ(index.checkpoints.front().uncompressed, 0);
+        for (size_t i = 1; i < index.checkpoints.size(); ++i) {
+            const auto& point = index.checkpoints[i];
+            EXPECT_GE(point.uncompressed - index.checkpoints[i - 1].uncompressed, 100000);
+            EXPECT_EQ(point.window.size(), 32768);
+            EXPECT_EQ(std::string(point.window.begin(), point.window.end()), x.substr(point.uncompressed - 32768, 32768));
+        }
+
+        // Resuming from each access point, and from in between.
+        for (const auto& point : index.checkpoints) {
+            comservatory::GzipIndexedReader reader(path, index, point.uncompressed);
+            EXPECT_EQ(read_all(reader), x.substr(point.uncompressed));
+
+            comservatory::GzipIndexedReader reader2(path, index, point.uncompressed + 12345);
+            EXPECT_EQ(read_all(reader2), x.substr(point.uncompressed + 12345));
+        }
+
+        comservatory::GzipIndexedReader reader(path, index, x.size());
+        EXPECT_EQ(read_all(reader), "");
+
+        // Round trip through the sidecar.
+        auto sidecar = path + ".gzi";
+        comservatory::save_gzip_index(index, sidecar);
+        auto loaded = comservatory::load_gzip_index(sidecar);
+        EXPECT_EQ(loaded.span, index.span);
+        EXPECT_EQ(loaded.size, index.size);
+        EXPECT_EQ(loaded.compressed_size, index.compressed_size);
+        ASSERT_EQ(loaded.checkpoints.size(), index.checkpoints.size());
+        for (size_t i = 0; i < index.checkpoints.size(); ++i) {
+            EXPECT_EQ(loaded.checkpoints[i].compressed, index.checkpoints[i].compressed);
+            EXPECT_EQ(loaded.checkpoints[i].bits, index.checkpoints[i].bits);
+            EXPECT_EQ(loaded.checkpoints[i].uncompressed, index.checkpoints[i].uncompressed);
+            EXPECT_EQ(loaded.checkpoints[i].window, index.checkpoints[i].window);
+        }
+    }
+}
+
+TEST_F(GzipIndexTest, Read) {
+    auto x = mock_records(50000);
+    auto path = temp_file_path("comservatory-gzindex");
+    write_gzip(path, x, 2);
+    auto index = comservatory::build_gzip_index(path, 100000);
+
+    auto ref = comservatory::read_buffer(x.c_str(), x.size(), comservatory::ReadOptions());
+    for (int nthreads : { 1, 2, 5 }) {
+        comservatory::ReadOptions opt;
+        opt.num_threads = nthreads;
+        opt.gzip_index = &index;
+        compare_contents(ref, comservatory::read_file(path, opt));
+    }
+
+    // Works with read_rows().
+    comservatory::RecordIndex rindex(100);
+    comservatory::ReadOptions ropt;
+    ropt.record_index = &rindex;
+    comservatory::read_file(path, ropt);
+    EXPECT_EQ(rindex.size, x.size());
+
+    comservatory::ReadOptions gopt;
+    gopt.gzip_index = &index;
+    for (auto range : std::vector<std::pair<size_t, size_t> >{ { 0, 10 }, { 1234, 1300 }, { 40000, 50000 } }) {
+        comservatory::ReadOptions lopt;
+        lopt.skip_records = range.first;
+        lopt.max_records = range.second - range.first;
+        auto lref = comservatory::read_buffer(x.c_str(), x.size(), lopt);
+        compare_contents(lref, comservatory::read_rows(path, rindex, range.first, range.second, gopt));
+    }
+}
+
+TEST_F(GzipIndexTest, Errors) {
+    auto x = mock_records(1000);
+    auto path = temp_file_path("comservatory-gzindex");
+    write_gzip(path, x);
+    auto index = comservatory::build_gzip_index(path, 1000);
+
+    auto copy = index;
+    ++copy.compressed_size;
+    EXPECT_ANY_THROW({
+        try {
+            comservatory::GzipIndexedReader reader(path, copy, 0);
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("does not match the size"));
+            throw;
+        }
+    });
+
+    EXPECT_ANY_THROW({
+        try {
+            comservatory::GzipIndexedReader reader(path, index, x.size() + 1);
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("beyond the end"));
+            throw;
+        }
+    });
+
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "foobar";
+    }
+    EXPECT_ANY_THROW({
+        try {
+            comservatory::build_gzip_index(path);
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("invalid Gzip"));
+            throw;
+        }
+    });
+}
+#endif
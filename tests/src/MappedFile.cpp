@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "comservatory/MappedFile.hpp"
+#include "temp_file_path.h"
+
+#include "utils.h"
+#include "compare_contents.h"
+
+#include <fstream>
+#include <string>
+
+#ifdef COMSERVATORY_HAS_MMAP
+static std::string dump_file(const std::string& contents) {
+    auto path = temp_file_path("comservatory-mmap");
+    std::ofstream out(path);
+    out << contents;
+    out.close();
+    return path;
+}
+
+static comservatory::Contents load_mapped(const std::string& path, int nthreads = 1) {
+    comservatory::ReadOptions opt;
+    opt.memory_map = true;
+    opt.num_threads = nthreads;
+    return comservatory::read_file(path, opt);
+}
+
+TEST(MappedFileTest, Basic) {
+    std::string x = "\"jayaram\",\"needs\",\"to get off\",\"his ass\"\n\"and start\",1,2,true\n";
+    auto path = dump_file(x);
+
+    comservatory::MappedFile mapped(path);
+    EXPECT_EQ(mapped.size(), x.size());
+    EXPECT_EQ(std::string(mapped.data(), mapped.size()), x);
+
+    auto ref = load_path(path);
+    compare_contents(ref, load_mapped(path));
+    compare_contents(ref, load_mapped(path, 2));
+
+    // Huge pages are just a hint.
+    comservatory::ReadOptions opt;
+    opt.memory_map = true;
+    opt.huge_pages = true;
+    compare_contents(ref, comservatory::read_file(path, opt));
+
+    // Works with validation.
+    comservatory::ReadOptions vopt;
+    vopt.memory_map = true;
+    vopt.validate_only = true;
+    auto val = comservatory::read_file(path, vopt);
+    EXPECT_EQ(val.num_records(), 1);
+    EXPECT_FALSE(val.fields[0]->filled());
+}
+
+TEST(MappedFileTest, StringViews) {
+    std::string x = "\"a\",\"b\"\n\"foo\",1\n\"b\"\"ar\",2\n";
+    auto path = dump_file(x);
+
+    comservatory::ReadOptions opt;
+    opt.memory_map = true;
+    opt.string_views = true;
+    auto out = comservatory::read_file(path, opt);
+    EXPECT_TRUE(out.backing != nullptr);
+
+    // The mapping is kept alive by the Contents.
+    auto mapped = std::static_pointer_cast<comservatory::MappedFile>(out.backing);
+    auto sptr = static_cast<const comservatory::StringViewField*>(out.fields[0].get());
+    EXPECT_EQ(sptr->values[0], "foo");
+    EXPECT_EQ(sptr->values[0].data(), mapped->data() + x.find("foo"));
+    EXPECT_EQ(sptr->values[1], "b\"ar");
+}
+
+TEST(MappedFileTest, Errors) {
+    auto path = dump_file("");
+    comservatory::MappedFile mapped(path);
+    EXPECT_EQ(mapped.size(), 0);
+    EXPECT_EQ(mapped.data(), nullptr);
+
+    EXPECT_ANY_THROW({
+        try {
+            load_mapped(path);
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("empty"));
+            throw;
+        }
+    });
+
+    EXPECT_ANY_THROW({
+        try {
+            comservatory::MappedFile mapped(path + "_missing");
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("failed to open"));
+            throw;
+        }
+    });
+}
+#endif
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "utils.h"
+#include "compare_contents.h"
+#include "temp_file_path.h"
+
+#include <string>
+#include <vector>
+#include <random>
+#include <fstream>
+
+#if __has_include("zlib.h")
+#include "zlib.h"
+
+static std::string mock_records(size_t n) {
+    std::mt19937_64 rng(n);
+    std::string x = "\"a\",\"b\",\"c\"\n";
+    for (size_t i = 0; i < n; ++i) {
+        x += std::to_string(i) + ",\"" + std::to_string(rng()) + "\"," + (rng() % 2 ? "true" : "false") + "\n";
+    }
+    return x;
+}
+
+static std::string read_all(byteme::Reader& reader, size_t chunk = 1000) {
+    std::string output;
+    std::vector<unsigned char> buffer(chunk);
+    while (1) {
+        size_t got = reader.read(buffer.data(), buffer.size());
+        output.insert(output.end(), buffer.begin(), buffer.begin() + got);
+        if (got < buffer.size()) {
+            break;
+        }
+    }
+    return output;
+}
+
+TEST(BlockedGzipTest, RoundTrip) {
+    auto x = mock_records(100000);
+
+    for (int nthreads : { 1, 3 }) {
+        auto path = temp_file_path("comservatory-bgzf");
+        {
+            comservatory::BlockedGzipWriter writer(path, nthreads, 6, 2);
+            // Writing in uneven pieces to check the buffering.
+            size_t start = 0, step = 12345;
+            while (start < x.size()) {
+                size_t len = std::min(step, x.size() - start);
+                writer.write(x.data() + start, len);
+                start += len;
+                step = step * 3 % 100000 + 1;
+            }
+            writer.finish();
+        }
+
+        // Readable as a normal Gzip file.
+        byteme::GzipFileReader serial(path, {});
+        EXPECT_EQ(read_all(serial), x);
+
+        for (int rthreads : { 1, 2, 4 }) {
+            comservatory::ParallelGzipReader reader(path, rthreads, 3);
+            EXPECT_TRUE(reader.blocked());
+            EXPECT_EQ(read_all(reader, 100000), x);
+        }
+
+        auto ref = comservatory::read_buffer(x.c_str(), x.size(), comservatory::ReadOptions());
+        comservatory::ReadOptions opt;
+        opt.num_threads = 3;
+        compare_contents(ref, comservatory::read_file(path, opt));
+    }
+
+    // Empty files are still valid.
+    auto path = temp_file_path("comservatory-bgzf");
+    {
+        comservatory::BlockedGzipWriter writer(path);
+    }
+    comservatory::ParallelGzipReader reader(path, 2);
+    EXPECT_TRUE(reader.blocked());
+    EXPECT_EQ(read_all(reader), "");
+}
+
+TEST(BlockedGzipTest, Incompressible) {
+    // Random bytes that can't be compressed into a single block.
+    std::mt19937_64 rng(42);
+    std::string x(200000, '\0');
+    for (auto& c : x) {
+        c = rng() % 256;
+    }
+
+    auto path = temp_file_path("comservatory-bgzf");
+    {
+        comservatory::BlockedGzipWriter writer(path, 2, 9);
+        writer.write(x);
+    }
+
+    comservatory::ParallelGzipReader reader(path, 2);
+    EXPECT_EQ(read_all(reader, 7777), x);
+}
+
+TEST(BlockedGzipTest, Fallback) {
+    auto x = mock_records(10000);
+    auto path = temp_file_path("comservatory-gz");
+    {
+        gzFile ohandle = gzopen(path.c_str(), "w");
+        gzwrite(ohandle, x.c_str(), x.size());
+        gzclose(ohandle);
+    }
+
+    comservatory::ParallelGzipReader reader(path, 3);
+    EXPECT_FALSE(reader.blocked());
+    EXPECT_EQ(read_all(reader), x);
+}
+
+TEST(BlockedGzipTest, Errors) {
+    auto x = mock_records(10000);
+    auto path = temp_file_path("comservatory-bgzf");
+    {
+        comservatory::BlockedGzipWriter writer(path);
+        writer.write(x);
+    }
+
+    std::string contents;
+    {
+        std::ifstream in(path, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    auto expect_error = [&](const std::string& modified, const std::string& msg) -> void {
+        auto mpath = temp_file_path("comservatory-bgzf");
+        {
+            std::ofstream out(mpath, std::ios::binary);
+            out << modified;
+        }
+        EXPECT_ANY_THROW({
+            try {
+                comservatory::ParallelGzipReader reader(mpath, 2);
+                read_all(reader);
+            } catch (std::exception& e) {
+                EXPECT_THAT(e.what(), ::testing::HasSubstr(msg));
+                throw;
+            }
+        });
+    };
+
+    expect_error(contents.substr(0, contents.size() - 10), "truncated");
+
+    auto corrupted = contents;
+    corrupted[100] ^= 0xff;
+    expect_error(corrupted, "BGZF block");
+}
+#endif
@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "utils.h"
+#include "temp_file_path.h"
+
+#include <string>
+#include <fstream>
+
+#if __has_include("zlib.h")
+#include "zlib.h"
+#endif
+
+// Each record has one string, one number, one boolean and one complex value, with a missing value every 7th record.
+static std::string mock_records(size_t n) {
+    std::string x = "\"a\",\"b\",\"c\",\"d\"\n";
+    for (size_t i = 0; i < n; ++i) {
+        x += "\"foo" + std::to_string(i) + "\"," + (i % 7 == 0 ? "NA" : std::to_string(i) + ".5") + "," + (i % 2 ? "true" : "FALSE") + ",1+" + std::to_string(i) + "i\n";
+    }
+    return x;
+}
+
+static void check_counts(const comservatory::ParseStats& stats, const std::string& x, size_t n) {
+    EXPECT_EQ(stats.bytes, x.size());
+    EXPECT_EQ(stats.records, n);
+    EXPECT_EQ(stats.fields, n * 4);
+
+    size_t nmissing = (n + 6) / 7;
+    EXPECT_EQ(stats.missing, nmissing);
+    EXPECT_EQ(stats.values[comservatory::STRING], n);
+    EXPECT_EQ(stats.values[comservatory::NUMBER], n - nmissing);
+    EXPECT_EQ(stats.values[comservatory::BOOLEAN], n);
+    EXPECT_EQ(stats.values[comservatory::COMPLEX], n);
+    EXPECT_EQ(stats.values[comservatory::INTEGER], 0);
+    EXPECT_EQ(stats.values[comservatory::UNKNOWN], 0);
+
+    EXPECT_GE(stats.read_time, 0);
+    EXPECT_GT(stats.parse_time, 0);
+    EXPECT_GT(stats.peak_buffered, 0);
+}
+
+TEST(ParseStatsTest, Buffer) {
+    auto x = mock_records(1000);
+    comservatory::ParseStats stats;
+    comservatory::ReadOptions opt;
+    opt.stats = &stats;
+
+    comservatory::read_buffer(x.c_str(), x.size(), opt);
+    check_counts(stats, x, 1000);
+    EXPECT_EQ(stats.read_time, 0);
+    EXPECT_EQ(stats.peak_buffered, x.size());
+
+    // Statistics are reset on the next read.
+    for (int nthreads : { 1, 3, 8 }) {
+        opt.num_threads = nthreads;
+        comservatory::read_buffer(x.c_str(), x.size(), opt);
+        check_counts(stats, x, 1000);
+    }
+}
+
+TEST(ParseStatsTest, File) {
+    auto x = mock_records(5000);
+    auto path = temp_file_path("comservatory-stats");
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << x;
+    }
+
+    comservatory::ParseStats stats;
+    comservatory::ReadOptions opt;
+    opt.stats = &stats;
+    opt.buffer_size = 1000;
+
+    comservatory::read_file(path, opt);
+    check_counts(stats, x, 5000);
+    EXPECT_EQ(stats.peak_buffered, 1000);
+
+    // Read-ahead buffers are also included.
+    opt.parallel = true;
+    for (size_t depth : { 1, 3 }) {
+        opt.prefetch_depth = depth;
+        comservatory::read_file(path, opt);
+        check_counts(stats, x, 5000);
+        EXPECT_GT(stats.peak_buffered, 1000);
+        EXPECT_LE(stats.peak_buffered, 1000 * (depth + 2));
+    }
+
+    // Loading the entire file before parsing it in parallel.
+    opt.parallel = false;
+    opt.num_threads = 3;
+    comservatory::read_file(path, opt);
+    check_counts(stats, x, 5000);
+    EXPECT_GE(stats.peak_buffered, x.size());
+
+#if __has_include("zlib.h")
+    auto gzpath = temp_file_path("comservatory-stats-gz");
+    {
+        gzFile ohandle = gzopen(gzpath.c_str(), "w");
+        gzwrite(ohandle, x.c_str(), x.size());
+        gzclose(ohandle);
+    }
+
+    opt.num_threads = 1;
+    comservatory::read_file(gzpath, opt);
+    check_counts(stats, x, 5000);
+    EXPECT_GT(stats.read_time, 0);
+#endif
+}
+
+TEST(ParseStatsTest, Limits) {
+    auto x = mock_records(100);
+    comservatory::ParseStats stats;
+    comservatory::ReadOptions opt;
+    opt.stats = &stats;
+    opt.skip_records = 10;
+    opt.max_records = 20;
+
+    auto y = mock_records(30);
+    size_t header = x.find('\n') + 1;
+    size_t skipped = mock_records(10).size() - header;
+
+    for (int nthreads : { 1, 3 }) {
+        opt.num_threads = nthreads;
+        comservatory::read_buffer(x.c_str(), x.size(), opt);
+        EXPECT_EQ(stats.records, 20);
+        EXPECT_EQ(stats.fields, 80);
+        EXPECT_EQ(stats.bytes, y.size());
+        EXPECT_EQ(stats.values[comservatory::STRING], 20);
+
+        // Skipped records are not included in the counts.
+        EXPECT_GT(stats.bytes, skipped);
+    }
+}
+
+TEST(ParseStatsTest, Types) {
+    std::string x = "\"a\",\"b\",\"c\"\n1,\"x\",NA\n-2,\"y\",3.5\n3,NA,NA\n";
+    comservatory::ParseStats stats;
+    comservatory::ReadOptions opt;
+    opt.stats = &stats;
+    opt.detect_integers = true;
+
+    comservatory::read_buffer(x.c_str(), x.size(), opt);
+    EXPECT_EQ(stats.values[comservatory::INTEGER], 3);
+    EXPECT_EQ(stats.values[comservatory::NUMBER], 1);
+    EXPECT_EQ(stats.values[comservatory::STRING], 2);
+    EXPECT_EQ(stats.missing, 3);
+
+    // Values that are only checked for their boundaries are counted as UNKNOWN.
+    opt.keep_subset = true;
+    opt.keep_subset_indices.push_back(0);
+    opt.dummy_validation = comservatory::ValidationLevel::STRUCTURE;
+    comservatory::read_buffer(x.c_str(), x.size(), opt);
+    EXPECT_EQ(stats.values[comservatory::INTEGER], 3);
+    EXPECT_GT(stats.values[comservatory::UNKNOWN], 0);
+    EXPECT_EQ(stats.fields, 9);
+
+    // No records.
+    std::string empty = "\"a\",\"b\"\n";
+    opt = comservatory::ReadOptions();
+    opt.stats = &stats;
+    comservatory::read_buffer(empty.c_str(), empty.size(), opt);
+    EXPECT_EQ(stats.records, 0);
+    EXPECT_EQ(stats.fields, 0);
+    EXPECT_EQ(stats.bytes, empty.size());
+}
@@ -119,6 +119,171 @@ TEST(LoadTest, Parallelized) {
     compare_contents(ref, par);
 }
 
+TEST(LoadTest, ArenaStrings) {
+    std::string x = "\"aaron\",\"britney\"\nNA,1\n\"foo\",2\n\"\"\"b,a\nr\"\"\",3\nNA,4\n\"\",5\n";
+    comservatory::ReadOptions opt;
+    opt.arena_strings = true;
+
+    byteme::RawBufferReader reader(raw_bytes(x), x.size());
+    auto ref = load_simple(reader);
+    auto rptr = static_cast<const comservatory::FilledStringField*>(ref.fields[0].get());
+
+    for (int t = 1; t <= 3; ++t) {
+        opt.num_threads = t;
+        auto output = comservatory::read_buffer(x.data(), x.size(), opt);
+        EXPECT_EQ(output.num_records(), 5);
+
+        auto optr = dynamic_cast<const comservatory::ArenaStringField*>(output.fields[0].get());
+        ASSERT_TRUE(optr != NULL);
+        EXPECT_EQ(optr->missing, rptr->missing);
+        for (size_t i = 0; i < 5; ++i) {
+            EXPECT_EQ(optr->get(i), rptr->values[i]);
+        }
+    }
+}
+
+TEST(LoadTest, StringViews) {
+    std::string x = "\"aaron\",\"britney\"\nNA,1\n\"foo\",2\n\"\"\"b,a\nr\"\"\",3\nNA,4\n\"\",5\n";
+    comservatory::ReadOptions opt;
+    opt.string_views = true;
+
+    byteme::RawBufferReader reader(raw_bytes(x), x.size());
+    auto ref = load_simple(reader);
+    auto rptr = static_cast<const comservatory::FilledStringField*>(ref.fields[0].get());
+
+    auto check = [&](const comservatory::Contents& output) -> const comservatory::StringViewField* {
+        EXPECT_EQ(output.num_records(), 5);
+        auto optr = dynamic_cast<const comservatory::StringViewField*>(output.fields[0].get());
+        EXPECT_TRUE(optr != NULL);
+        EXPECT_EQ(optr->missing, rptr->missing);
+        EXPECT_EQ(optr->values.size(), rptr->values.size());
+        for (size_t i = 0; i < optr->values.size(); ++i) {
+            EXPECT_EQ(optr->values[i], rptr->values[i]);
+        }
+        return optr;
+    };
+
+    for (int t = 1; t <= 3; ++t) {
+        opt.num_threads = t;
+        auto output = comservatory::read_buffer(x.data(), x.size(), opt);
+        auto optr = check(output);
+        EXPECT_TRUE(output.backing == nullptr);
+
+        // Unescaped strings point into the buffer.
+        EXPECT_EQ(optr->values[1].data(), x.data() + x.find("foo"));
+    }
+
+    // Streaming inputs are loaded into a buffer that is owned by the Contents.
+    byteme::RawBufferReader reader2(raw_bytes(x), x.size());
+    opt.num_threads = 1;
+    auto output = comservatory::read(reader2, opt);
+    check(output);
+    EXPECT_TRUE(output.backing != nullptr);
+}
+
+template<typename T, comservatory::Type tt>
+static void compare_masked(const comservatory::Field* ref, const comservatory::Field* out) {
+    auto rptr = static_cast<const comservatory::FilledField<T, tt>*>(ref);
+    auto optr = dynamic_cast<const comservatory::MaskedField<T, tt>*>(out);
+    ASSERT_TRUE(optr != NULL);
+    ASSERT_EQ(optr->size(), rptr->size());
+
+    std::vector<size_t> missing;
+    for (size_t i = 0; i < optr->size(); ++i) {
+        if (optr->is_missing(i)) {
+            missing.push_back(i);
+        } else {
+            EXPECT_EQ(optr->get(i), rptr->values[i]);
+        }
+    }
+    EXPECT_EQ(missing, rptr->missing);
+}
+
+TEST(LoadTest, MissingBitmap) {
+    std::string x = "\"a\",\"b\",\"c\",\"d\"\n";
+    for (size_t i = 0; i < 500; ++i) {
+        x += (i < 400 ? std::string("NA") : std::to_string(i)) + ",";
+        x += (i % 3 ? "\"foo\"," : "NA,");
+        x += (i % 5 ? "true," : "NA,");
+        x += (i % 7 ? std::to_string(i) + "+1i\n" : std::string("NA\n"));
+    }
+
+    byteme::RawBufferReader reader(raw_bytes(x), x.size());
+    auto ref = load_simple(reader);
+
+    comservatory::ReadOptions opt;
+    opt.missing_bitmap = true;
+    for (int t = 1; t <= 4; ++t) {
+        opt.num_threads = t;
+        auto out = comservatory::read_buffer(x.data(), x.size(), opt);
+        compare_masked<double, comservatory::NUMBER>(ref.fields[0].get(), out.fields[0].get());
+        compare_masked<std::string, comservatory::STRING>(ref.fields[1].get(), out.fields[1].get());
+        compare_masked<bool, comservatory::BOOLEAN>(ref.fields[2].get(), out.fields[2].get());
+        compare_masked<std::complex<double>, comservatory::COMPLEX>(ref.fields[3].get(), out.fields[3].get());
+
+        // Leading run of missing values is not materialized.
+        auto nptr = static_cast<const comservatory::MaskedNumberField*>(out.fields[0].get());
+        EXPECT_EQ(nptr->leading, 400);
+        EXPECT_EQ(nptr->values.size(), 100);
+    }
+
+    // Works with integer promotion.
+    std::string y = "\"a\"\nNA\n1\nNA\n2.5\n";
+    opt.num_threads = 1;
+    opt.detect_integers = true;
+    auto out = comservatory::read_buffer(y.data(), y.size(), opt);
+    auto yptr = dynamic_cast<const comservatory::MaskedNumberField*>(out.fields[0].get());
+    ASSERT_TRUE(yptr != NULL);
+    EXPECT_EQ(yptr->leading, 1);
+    EXPECT_TRUE(yptr->is_missing(2));
+    EXPECT_EQ(yptr->get(1), 1);
+    EXPECT_EQ(yptr->get(3), 2.5);
+}
+
+TEST(LoadTest, Staging) {
+    // Long runs of values and missing values, to check that staged values are flushed in the right order.
+    std::string x = "\"a\",\"b\",\"c\",\"d\"\n";
+    std::vector<double> expected_a;
+    std::vector<size_t> missing_a, missing_b;
+    std::vector<bool> expected_c;
+    for (size_t i = 0; i < 1000; ++i) {
+        bool is_missing = (i / 50) % 3 == 0 || i % 7 == 0;
+        if (is_missing) {
+            x += "NA,";
+            missing_a.push_back(i);
+        } else {
+            x += std::to_string(i) + ",";
+        }
+        expected_a.push_back(is_missing ? 0 : i);
+
+        if (i % 130 == 0) {
+            x += "NA,";
+            missing_b.push_back(i);
+        } else {
+            x += std::to_string(i) + "+" + std::to_string(i) + "i,";
+        }
+
+        x += (i % 3 ? "TRUE," : "false,");
+        expected_c.push_back(i % 3);
+        x += "\"foo\"\n";
+    }
+
+    auto output = comservatory::read_buffer(x.data(), x.size(), comservatory::ReadOptions());
+    EXPECT_EQ(output.num_records(), 1000);
+
+    auto aptr = static_cast<const comservatory::FilledNumberField*>(output.fields[0].get());
+    EXPECT_EQ(aptr->values, expected_a);
+    EXPECT_EQ(aptr->missing, missing_a);
+
+    auto bptr = static_cast<const comservatory::FilledComplexField*>(output.fields[1].get());
+    EXPECT_EQ(bptr->missing, missing_b);
+    EXPECT_EQ(bptr->values[999], std::complex<double>(999, 999));
+
+    auto cptr = static_cast<const comservatory::FilledBooleanField*>(output.fields[2].get());
+    EXPECT_EQ(cptr->values, expected_c);
+    EXPECT_EQ(output.fields[3]->size(), 1000);
+}
+
 TEST(LoadTest, OneColumn) {
     std::string x = "\"aaron\"\n1\n2\n3\n";
     byteme::RawBufferReader reader(raw_bytes(x), x.size());
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "utils.h"
+#include "compare_contents.h"
+
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <stdexcept>
+
+// Returns the data in uneven pieces, without exposing contiguous storage.
+class ChunkedReader : public byteme::Reader {
+public:
+    ChunkedReader(const std::string& x, size_t fail_at = -1) : contents(x), fail_at(fail_at), rng(x.size()) {}
+
+    size_t read(unsigned char* buffer, size_t n) {
+        if (position >= fail_at) {
+            throw std::runtime_error("failed to read the source");
+        }
+        size_t available = std::min({ n, contents.size() - position, static_cast<size_t>(rng() % 100 + 1) });
+        std::copy_n(contents.data() + position, available, buffer);
+        position += available;
+        return available;
+    }
+
+private:
+    std::string contents;
+    size_t fail_at;
+    size_t position = 0;
+    std::mt19937_64 rng;
+};
+
+static std::string mock_records(size_t n) {
+    std::mt19937_64 rng(n);
+    std::string x = "\"a\",\"b\",\"c\"\n";
+    for (size_t i = 0; i < n; ++i) {
+        x += std::to_string(i) + ",\"" + std::to_string(rng()) + "\n,\"\"\"," + (rng() % 2 ? "true" : "false") + "\n";
+    }
+    return x;
+}
+
+TEST(PrefetchReaderTest, Basic) {
+    auto x = mock_records(1000);
+
+    for (size_t depth : { 1, 2, 5 }) {
+        for (size_t bufsize : { 1, 13, 1000 }) {
+            ChunkedReader source(x);
+            comservatory::PrefetchReader reader(&source, bufsize, depth);
+
+            std::string output;
+            std::vector<unsigned char> buffer(777);
+            while (1) {
+                size_t got = reader.read(buffer.data(), buffer.size());
+                output.insert(output.end(), buffer.begin(), buffer.begin() + got);
+                if (got < buffer.size()) {
+                    break;
+                }
+            }
+            EXPECT_EQ(output, x);
+
+            // Subsequent reads report the end of the stream.
+            EXPECT_EQ(reader.read(buffer.data(), buffer.size()), 0);
+        }
+    }
+
+    // Destruction before the stream is consumed.
+    ChunkedReader source(x);
+    comservatory::PrefetchReader reader(&source, 10, 3);
+}
+
+TEST(PrefetchReaderTest, Error) {
+    auto x = mock_records(1000);
+    ChunkedReader source(x, 5000);
+    comservatory::PrefetchReader reader(&source, 100, 3);
+
+    std::vector<unsigned char> buffer(x.size());
+    EXPECT_ANY_THROW({
+        try {
+            reader.read(buffer.data(), buffer.size());
+        } catch (std::exception& e) {
+            EXPECT_THAT(std::string(e.what()), ::testing::HasSubstr("failed to read"));
+            throw;
+        }
+    });
+}
+
+TEST(PrefetchReaderTest, Read) {
+    auto x = mock_records(2000);
+    auto ref = comservatory::read_buffer(x.c_str(), x.size(), comservatory::ReadOptions());
+
+    for (bool parallel : { false, true }) {
+        for (size_t depth : { 1, 3 }) {
+            for (size_t bufsize : { 7, 4096 }) {
+                comservatory::ReadOptions opt;
+                opt.parallel = parallel;
+                opt.prefetch_depth = depth;
+                opt.buffer_size = bufsize;
+
+                ChunkedReader reader(x);
+                compare_contents(ref, comservatory::read(reader, opt));
+
+                ChunkedReader breader(x);
+                comservatory::BatchReader<ChunkedReader> batches(breader, 500, opt);
+                size_t total = 0;
+                comservatory::Contents batch;
+                while (batches.next(batch)) {
+                    total += batch.num_records();
+                }
+                EXPECT_EQ(total, 2000);
+            }
+        }
+    }
+
+    // Errors in the reader are propagated to the caller.
+    comservatory::ReadOptions opt;
+    opt.parallel = true;
+    opt.prefetch_depth = 3;
+    ChunkedReader reader(x, 1000);
+    EXPECT_ANY_THROW(comservatory::read(reader, opt));
+}
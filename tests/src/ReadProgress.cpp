@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "utils.h"
+#include "compare_contents.h"
+#include "temp_file_path.h"
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+static std::string mock_records(size_t n) {
+    std::string x = "\"a\",\"b\"\n";
+    for (size_t i = 0; i < n; ++i) {
+        x += std::to_string(i) + ",\"foo\n" + std::to_string(i) + "\"\n";
+    }
+    return x;
+}
+
+TEST(ReadProgressTest, Records) {
+    auto x = mock_records(1000);
+    auto ref = comservatory::read_buffer(x.c_str(), x.size(), comservatory::ReadOptions());
+
+    std::vector<comservatory::ReadProgress> reports;
+    comservatory::ReadOptions opt;
+    opt.progress = [&](const comservatory::ReadProgress& p) -> bool {
+        reports.push_back(p);
+        return true;
+    };
+    opt.progress_bytes = 0;
+    opt.progress_records = 100;
+
+    compare_contents(ref, comservatory::read_buffer(x.c_str(), x.size(), opt));
+    ASSERT_EQ(reports.size(), 10);
+    for (size_t i = 0; i < reports.size(); ++i) {
+        EXPECT_EQ(reports[i].records, (i + 1) * 100);
+        EXPECT_EQ(reports[i].bytes, mock_records((i + 1) * 100).size());
+    }
+
+    // Same results for multiple threads, though the reports may be in a different order.
+    reports.clear();
+    opt.num_threads = 4;
+    compare_contents(ref, comservatory::read_buffer(x.c_str(), x.size(), opt));
+    EXPECT_FALSE(reports.empty());
+    for (size_t i = 1; i < reports.size(); ++i) {
+        EXPECT_GT(reports[i].records, reports[i - 1].records);
+        EXPECT_GT(reports[i].bytes, reports[i - 1].bytes);
+    }
+    EXPECT_LE(reports.back().records, 1000);
+    EXPECT_LE(reports.back().bytes, x.size());
+}
+
+TEST(ReadProgressTest, Bytes) {
+    auto x = mock_records(1000);
+    auto path = temp_file_path("comservatory-progress");
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << x;
+    }
+
+    std::vector<comservatory::ReadProgress> reports;
+    comservatory::ReadOptions opt;
+    opt.progress = [&](const comservatory::ReadProgress& p) -> bool {
+        reports.push_back(p);
+        return true;
+    };
+    opt.progress_bytes = 1000;
+    opt.buffer_size = 100;
+
+    comservatory::read_file(path, opt);
+    EXPECT_EQ(reports.size(), x.size() / 1000);
+    for (size_t i = 1; i < reports.size(); ++i) {
+        EXPECT_GE(reports[i].bytes - reports[i - 1].bytes, 1000);
+    }
+
+    // No calls if both intervals are zero.
+    reports.clear();
+    opt.progress_bytes = 0;
+    comservatory::read_file(path, opt);
+    EXPECT_TRUE(reports.empty());
+}
+
+TEST(ReadProgressTest, Cancel) {
+    auto x = mock_records(10000);
+
+    for (int nthreads : { 1, 3 }) {
+        size_t calls = 0;
+        comservatory::ReadOptions opt;
+        opt.num_threads = nthreads;
+        opt.progress = [&](const comservatory::ReadProgress& p) -> bool {
+            ++calls;
+            return p.records < 500;
+        };
+        opt.progress_bytes = 0;
+        opt.progress_records = 100;
+
+        comservatory::Contents contents;
+        bool cancelled = false;
+        try {
+            comservatory::read_buffer(x.c_str(), x.size(), contents, opt);
+        } catch (comservatory::ReadCancelled& e) {
+            cancelled = true;
+            EXPECT_THAT(std::string(e.what()), ::testing::HasSubstr("cancelled"));
+        }
+
+        EXPECT_TRUE(cancelled);
+        EXPECT_EQ(calls, 5);
+        EXPECT_TRUE(contents.fields.empty());
+        EXPECT_TRUE(contents.names.empty());
+        EXPECT_EQ(contents.num_records(), 0);
+    }
+
+    // Streaming reads are also cancelled.
+    comservatory::ReadOptions opt;
+    opt.progress = [&](const comservatory::ReadProgress&) -> bool { return false; };
+    opt.progress_records = 1;
+    byteme::RawBufferReader reader(raw_bytes(x), x.size());
+    EXPECT_THROW(comservatory::read(reader, opt), comservatory::ReadCancelled);
+
+    // Invalid files still report the usual errors.
+    opt.progress = [&](const comservatory::ReadProgress&) -> bool { return true; };
+    std::string y = "\"a\"\n1\n\"b\"\n";
+    EXPECT_ANY_THROW({
+        try {
+            comservatory::read_buffer(y.c_str(), y.size(), opt);
+        } catch (comservatory::ReadCancelled& e) {
+            FAIL() << "should not be cancelled";
+        } catch (std::exception& e) {
+            EXPECT_THAT(std::string(e.what()), ::testing::HasSubstr("do not match"));
+            throw;
+        }
+    });
+}
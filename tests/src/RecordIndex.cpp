@@ -0,0 +1,251 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "utils.h"
+#include "compare_contents.h"
+#include "temp_file_path.h"
+#include "byteme/byteme.hpp"
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+
+static std::string mock_records(size_t n) {
+    std::string x = "\"a\",\"b\"\n";
+    for (size_t i = 0; i < n; ++i) {
+        x += std::to_string(i) + ",\"foo\n" + std::to_string(i) + "\"\n";
+    }
+    return x;
+}
+
+// Offsets of every record, computed the slow way.
+static std::vector<uint64_t> all_offsets(const std::string& x) {
+    std::vector<uint64_t> output;
+    bool in_quotes = false;
+    for (size_t i = 0; i < x.size(); ++i) {
+        if (x[i] == '"') {
+            in_quotes = !in_quotes;
+        } else if (x[i] == '\n' && !in_quotes && i + 1 < x.size()) {
+            output.push_back(i + 1);
+        }
+    }
+    return output;
+}
+
+// Non-contiguous reader, to check the offsets from a buffered stream.
+struct StreamingReader : public byteme::Reader {
+    StreamingReader(const std::string& x) : contents(x) {}
+
+    size_t read(unsigned char* buffer, size_t n) {
+        n = std::min(n, contents.size() - total);
+        std::copy_n(contents.data() + total, n, buffer);
+        total += n;
+        return n;
+    }
+
+    const std::string& contents;
+    size_t total = 0;
+};
+
+static comservatory::RecordIndex build_index(const std::string& x, size_t interval, int nthreads) {
+    comservatory::RecordIndex index(interval);
+    comservatory::ReadOptions opt;
+    opt.num_threads = nthreads;
+    opt.record_index = &index;
+    comservatory::read_buffer(x.c_str(), x.size(), opt);
+    return index;
+}
+
+TEST(RecordIndexTest, Build) {
+    auto x = mock_records(100);
+    auto expected = all_offsets(x);
+
+    for (size_t interval : { 1, 7, 10, 100, 1000 }) {
+        auto index = build_index(x, interval, 1);
+        EXPECT_EQ(index.interval, interval);
+        EXPECT_EQ(index.num_records, 100);
+        EXPECT_EQ(index.size, x.size());
+
+        std::vector<uint64_t> sampled;
+        for (size_t i = 0; i < expected.size(); i += interval) {
+            sampled.push_back(expected[i]);
+        }
+        EXPECT_EQ(index.offsets, sampled);
+
+        // Same results with multiple threads.
+        for (int nthreads : { 2, 3, 7 }) {
+            auto pindex = build_index(x, interval, nthreads);
+            EXPECT_EQ(pindex.offsets, index.offsets);
+            EXPECT_EQ(pindex.num_records, index.num_records);
+            EXPECT_EQ(pindex.size, index.size);
+        }
+
+        // Same results when streaming.
+        comservatory::RecordIndex sindex(interval);
+        comservatory::ReadOptions opt;
+        opt.record_index = &sindex;
+        StreamingReader reader(x);
+        comservatory::read(reader, opt);
+        EXPECT_EQ(sindex.offsets, index.offsets);
+        EXPECT_EQ(sindex.num_records, index.num_records);
+        EXPECT_EQ(sindex.size, index.size);
+    }
+}
+
+TEST(RecordIndexTest, EdgeCases) {
+    std::string x = "\"a\",\"b\"\n";
+    auto index = build_index(x, 10, 1);
+    EXPECT_TRUE(index.offsets.empty());
+    EXPECT_EQ(index.num_records, 0);
+    EXPECT_EQ(index.size, x.size());
+
+    x += "1,2\n";
+    index = build_index(x, 10, 1);
+    EXPECT_EQ(index.offsets, std::vector<uint64_t>{ 8 });
+    EXPECT_EQ(index.num_records, 1);
+    EXPECT_EQ(index.size, x.size());
+
+    size_t skip;
+    EXPECT_EQ(index.locate(0, skip), 8);
+    EXPECT_EQ(skip, 0);
+    EXPECT_ANY_THROW({
+        try {
+            index.locate(1, skip);
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("out of range"));
+            throw;
+        }
+    });
+
+    // Can't be combined with limits.
+    comservatory::ReadOptions opt;
+    opt.record_index = &index;
+    opt.skip_records = 1;
+    EXPECT_ANY_THROW({
+        try {
+            comservatory::read_buffer(x.c_str(), x.size(), opt);
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("skipping or limiting"));
+            throw;
+        }
+    });
+}
+
+TEST(RecordIndexTest, Locate) {
+    auto x = mock_records(100);
+    auto index = build_index(x, 7, 1);
+    auto expected = all_offsets(x);
+
+    for (size_t r = 0; r < 100; ++r) {
+        size_t skip;
+        auto offset = index.locate(r, skip);
+        EXPECT_EQ(offset, expected[r - skip]);
+        EXPECT_EQ(skip, r % 7);
+    }
+}
+
+TEST(RecordIndexTest, Split) {
+    auto x = mock_records(1000);
+    auto index = build_index(x, 13, 1);
+    auto ref = comservatory::read_buffer(x.c_str(), x.size(), comservatory::ReadOptions());
+
+    for (int nthreads : { 2, 3, 10 }) {
+        comservatory::ReadOptions opt;
+        opt.num_threads = nthreads;
+        opt.split_index = &index;
+        compare_contents(ref, comservatory::read_buffer(x.c_str(), x.size(), opt));
+
+        // Works with limits.
+        comservatory::ReadOptions lopt;
+        lopt.skip_records = 100;
+        lopt.max_records = 500;
+        auto lref = comservatory::read_buffer(x.c_str(), x.size(), lopt);
+        EXPECT_EQ(lref.num_records(), 500);
+
+        lopt.num_threads = nthreads;
+        lopt.split_index = &index;
+        compare_contents(lref, comservatory::read_buffer(x.c_str(), x.size(), lopt));
+
+        lopt.skip_records = 130; // exactly on a sampled record.
+        lopt.max_records = 900;
+        auto lout = comservatory::read_buffer(x.c_str(), x.size(), lopt);
+        EXPECT_EQ(lout.num_records(), 870);
+        EXPECT_EQ(static_cast<const comservatory::FilledNumberField*>(lout.fields[0].get())->values.front(), 130);
+    }
+
+    // Errors are still reported.
+    std::string y = x + "\"x\",\"2\"\n";
+    auto yindex = build_index(x + "123,\"2\"\n", 13, 1);
+    comservatory::ReadOptions opt;
+    opt.num_threads = 3;
+    opt.split_index = &yindex;
+    EXPECT_ANY_THROW({
+        try {
+            comservatory::read_buffer(y.c_str(), y.size(), opt);
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("do not match up"));
+            throw;
+        }
+    });
+
+    // Fails for a different file.
+    opt.split_index = &index;
+    EXPECT_ANY_THROW({
+        try {
+            comservatory::read_buffer(y.c_str(), y.size(), opt);
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("does not match the size"));
+            throw;
+        }
+    });
+
+    y = "\"a\",\"b\"\n1" + x.substr(8, x.size() - 9); // same size but shifted records.
+    EXPECT_ANY_THROW({
+        try {
+            comservatory::read_buffer(y.c_str(), y.size(), opt);
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("does not match the contents"));
+            throw;
+        }
+    });
+}
+
+TEST(RecordIndexTest, Sidecar) {
+    auto x = mock_records(100);
+    auto index = build_index(x, 7, 1);
+
+    auto path = temp_file_path("comservatory-index");
+    comservatory::save_record_index(index, path);
+    auto loaded = comservatory::load_record_index(path);
+    EXPECT_EQ(loaded.interval, index.interval);
+    EXPECT_EQ(loaded.offsets, index.offsets);
+    EXPECT_EQ(loaded.num_records, index.num_records);
+    EXPECT_EQ(loaded.size, index.size);
+
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "foobar";
+    }
+    EXPECT_ANY_THROW({
+        try {
+            comservatory::load_record_index(path);
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("unrecognized"));
+            throw;
+        }
+    });
+
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "CSVRIDX1abc";
+    }
+    EXPECT_ANY_THROW({
+        try {
+            comservatory::load_record_index(path);
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("truncated"));
+            throw;
+        }
+    });
+}
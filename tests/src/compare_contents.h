@@ -50,6 +50,14 @@ inline void compare_contents(const comservatory::Contents& ref, const comservato
                     EXPECT_EQ(left->missing, right->missing);
                 }
                 break;
+            case comservatory::INTEGER:
+                {
+                    comservatory::FilledIntegerField* left = static_cast<comservatory::FilledIntegerField*>(optr);
+                    comservatory::FilledIntegerField* right = static_cast<comservatory::FilledIntegerField*>(rptr);
+                    EXPECT_EQ(left->values, right->values);
+                    EXPECT_EQ(left->missing, right->missing);
+                }
+                break;
             case comservatory::UNKNOWN:
                 break;
         }
@@ -6,6 +6,10 @@
 
 #include "utils.h"
 
+#include <random>
+#include <cstdlib>
+#include <limits>
+
 double convert_to_number(std::string x) {
     x = "\"foo\"\n" + x + "\n";
     byteme::RawBufferReader reader(reinterpret_cast<const unsigned char*>(x.c_str()), x.size());
@@ -19,6 +23,14 @@ double convert_to_number(std::string x) {
     return v[0];
 }
 
+double convert_to_number_buffer(std::string x) {
+    x = "\"foo\"\n" + x + "\n";
+    auto output = comservatory::read_buffer(x.c_str(), x.size(), comservatory::ReadOptions());
+    const auto& v = static_cast<const comservatory::FilledNumberField*>(output.fields[0].get())->values;
+    EXPECT_EQ(v.size(), 1);
+    return v[0];
+}
+
 TEST(ConvertTest, Integer) {
     // Basic example.
     EXPECT_EQ(convert_to_number("12345"), 12345);
@@ -60,6 +72,56 @@ TEST(ConvertTest, ScientificFloat) {
     EXPECT_FLOAT_EQ(convert_to_number("4E-3"), 0.004);
 }
 
+TEST(ConvertTest, CorrectRounding) {
+    std::vector<std::string> cases {
+        "0.1",
+        "0.3",
+        "1.7976931348623157e308",
+        "2.2250738585072014e-308",
+        "4.9e-324", // subnormal.
+        "9.007199254740993", // more than 2^53.
+        "123456789012345678901234567890",
+        "1.00000000000000011102230246251565404236316680908203125", // exactly halfway.
+        "3.14159265358979323846264338327950288419716939937510",
+        "0.000000000000000000000000000000000000001234567890123456789",
+        "12345678.87654321",
+        "00000000000000000000000000001.5",
+        "1.5e-00000000000000000000000010",
+        "9.999999999999999999999999e22",
+        "1e23",
+        "7.2057594037927933e16"
+    };
+
+    for (const auto& x : cases) {
+        double expected = std::strtod(x.c_str(), NULL);
+        EXPECT_EQ(convert_to_number(x), expected) << x;
+        EXPECT_EQ(convert_to_number_buffer(x), expected) << x;
+    }
+
+    // Randomized tests with long mantissas and exponents.
+    std::mt19937_64 rng(100);
+    for (size_t i = 0; i < 1000; ++i) {
+        std::string x = std::to_string(rng() % 9 + 1) + ".";
+        size_t ndigits = rng() % 25 + 1;
+        for (size_t d = 0; d < ndigits; ++d) {
+            x += std::to_string(rng() % 10);
+        }
+        if (rng() % 2) {
+            int exponent = static_cast<int>(rng() % 600) - 300;
+            x += "e" + std::to_string(exponent);
+        }
+
+        double expected = std::strtod(x.c_str(), NULL);
+        EXPECT_EQ(convert_to_number(x), expected) << x;
+        EXPECT_EQ(convert_to_number_buffer(x), expected) << x;
+    }
+
+    // Overflow and underflow.
+    EXPECT_TRUE(std::isinf(convert_to_number("1e400")));
+    EXPECT_EQ(convert_to_number("1e-400"), 0);
+    EXPECT_EQ(convert_to_number("1e99999999999999999999"), std::numeric_limits<double>::infinity());
+}
+
 TEST(ConvertTest, SpecialNumber) {
     for (auto x : std::vector<std::string>{"inf", "Inf", "INF"}) {
         auto val = convert_to_number(x);
@@ -92,6 +154,8 @@ TEST(ConvertTest, NumberFail) {
     simple_conversion_fail(".0\n", "unknown type starting with '.'");
 
     simple_conversion_fail("10e1\n", "absolute value");
+    simple_conversion_fail("0.5e1\n", "absolute value");
+    simple_conversion_fail("00.5e1\n", "absolute value");
     simple_conversion_fail("1e", "should be terminated with a newline");
     simple_conversion_fail("1e\n", "should be followed by a sign or digit");
     simple_conversion_fail("1e+", "should be terminated with a newline");
@@ -55,3 +55,26 @@ TEST(ConvertTest, StringFail) {
     simple_conversion_fail("\"asdasd\"asdasd\"\n", "trailing character 'a'");
     simple_conversion_fail("\"asdasdasdasd\"\"\n", "truncated string");
 }
+
+TEST(ConvertTest, LongString) {
+    // Longer than the staging buffer, with escapes on either side of the flush.
+    std::string raw, expected;
+    for (size_t i = 0; i < 2000; ++i) {
+        if (i % 97 == 0 || i == 255 || i == 256) {
+            raw += "\"\"";
+            expected += '"';
+        } else {
+            char c = 'a' + (i % 26);
+            raw += c;
+            expected += c;
+        }
+    }
+    EXPECT_EQ(convert_to_string(raw), expected);
+
+    std::string x = "\"foo\"\n\"" + raw + "\"\n";
+    auto output = comservatory::read_buffer(x.data(), x.size(), comservatory::ReadOptions());
+    EXPECT_EQ(static_cast<const comservatory::FilledStringField*>(output.fields[0].get())->values[0], expected);
+
+    // Escapes at the very start and end.
+    EXPECT_EQ(convert_to_string("\"\"a\"\""), "\"a\"");
+}
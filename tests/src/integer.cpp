@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "utils.h"
+#include "compare_contents.h"
+#include "byteme/byteme.hpp"
+
+#include <cstdint>
+#include <string>
+
+static comservatory::Contents load_integers(const std::string& x, int nthreads = 1) {
+    comservatory::ReadOptions opt;
+    opt.detect_integers = true;
+    opt.num_threads = nthreads;
+    byteme::RawBufferReader reader(raw_bytes(x), x.size());
+    return comservatory::read(reader, opt);
+}
+
+TEST(IntegerTest, Basic) {
+    std::string x = "\"a\",\"b\",\"c\"\n1,-2,NA\n+30,9007199254740993,NA\n0004,-9223372036854775808,5\n";
+    auto out = load_integers(x);
+    EXPECT_EQ(out.num_records(), 3);
+
+    EXPECT_EQ(out.fields[0]->type(), comservatory::INTEGER);
+    auto aptr = static_cast<const comservatory::FilledIntegerField*>(out.fields[0].get());
+    EXPECT_EQ(aptr->values, std::vector<int64_t>({ 1, 30, 4 }));
+
+    // Values beyond 2^53 are stored exactly.
+    EXPECT_EQ(out.fields[1]->type(), comservatory::INTEGER);
+    auto bptr = static_cast<const comservatory::FilledIntegerField*>(out.fields[1].get());
+    EXPECT_EQ(bptr->values, std::vector<int64_t>({ -2, 9007199254740993, std::numeric_limits<int64_t>::min() }));
+
+    EXPECT_EQ(out.fields[2]->type(), comservatory::INTEGER);
+    auto cptr = static_cast<const comservatory::FilledIntegerField*>(out.fields[2].get());
+    EXPECT_EQ(cptr->missing, std::vector<size_t>({ 0, 1 }));
+    EXPECT_EQ(cptr->values.back(), 5);
+
+    // Default behavior is unchanged.
+    byteme::RawBufferReader reader(raw_bytes(x), x.size());
+    auto ref = load_simple(reader);
+    EXPECT_EQ(ref.fields[0]->type(), comservatory::NUMBER);
+}
+
+TEST(IntegerTest, Promotion) {
+    std::string x = "\"a\",\"b\",\"c\",\"d\",\"e\"\n1,2,3,4,5+1i\n5,NA,1e2,-inf,NA\nNA,2.5,nan,9223372036854775808,1+0i\n";
+    auto out = load_integers(x);
+
+    EXPECT_EQ(out.fields[0]->type(), comservatory::INTEGER);
+    for (size_t i = 1; i < 4; ++i) {
+        EXPECT_EQ(out.fields[i]->type(), comservatory::NUMBER);
+    }
+
+    auto bptr = static_cast<const comservatory::FilledNumberField*>(out.fields[1].get());
+    EXPECT_EQ(bptr->values, std::vector<double>({ 2, 0, 2.5 }));
+    EXPECT_EQ(bptr->missing, std::vector<size_t>({ 1 }));
+
+    // Integers after promotion are still stored as doubles.
+    std::string y = "\"a\"\n1\n2.5\n3\n";
+    auto out2 = load_integers(y);
+    auto yptr = static_cast<const comservatory::FilledNumberField*>(out2.fields[0].get());
+    EXPECT_EQ(yptr->values, std::vector<double>({ 1, 2.5, 3 }));
+
+    // Complex numbers are still complex.
+    EXPECT_EQ(out.fields[4]->type(), comservatory::COMPLEX);
+    EXPECT_ANY_THROW(load_integers("\"a\"\n1\n1+1i\n"));
+    EXPECT_ANY_THROW(load_integers("\"a\"\n1\n\"foo\"\n"));
+}
+
+TEST(IntegerTest, Parallel) {
+    std::string x = "\"a\",\"b\",\"c\",\"d\"\n";
+    for (size_t i = 0; i < 200; ++i) {
+        x += std::to_string(i) + ",";
+        x += (i == 150 ? std::string("1.5") : std::to_string(i)) + ",";
+        x += (i == 20 ? std::string("0.5") : std::to_string(i)) + ",";
+        x += (i < 190 ? std::string("NA") : std::to_string(i)) + "\n";
+    }
+
+    auto ref = load_integers(x);
+    EXPECT_EQ(ref.fields[0]->type(), comservatory::INTEGER);
+    EXPECT_EQ(ref.fields[1]->type(), comservatory::NUMBER);
+    EXPECT_EQ(ref.fields[2]->type(), comservatory::NUMBER);
+    EXPECT_EQ(ref.fields[3]->type(), comservatory::INTEGER);
+
+    for (int t = 2; t <= 6; ++t) {
+        compare_contents(ref, load_integers(x, t));
+    }
+}
+
+TEST(IntegerTest, Validation) {
+    comservatory::ReadOptions opt;
+    opt.detect_integers = true;
+    opt.validate_only = true;
+    std::string x = "\"a\",\"b\"\n1,2\n3,4.5\n";
+    auto out = comservatory::read_buffer(x.data(), x.size(), opt);
+    EXPECT_EQ(out.fields[0]->type(), comservatory::INTEGER);
+    EXPECT_EQ(out.fields[1]->type(), comservatory::NUMBER);
+    EXPECT_FALSE(out.fields[1]->filled());
+    EXPECT_EQ(out.fields[1]->size(), 2);
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "utils.h"
+#include "compare_contents.h"
+#include "byteme/byteme.hpp"
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+static std::string mock_records(size_t n) {
+    std::string x = "\"a\",\"b\"\n";
+    for (size_t i = 0; i < n; ++i) {
+        x += std::to_string(i) + ",\"foo\n" + std::to_string(i) + "\"\n";
+    }
+    return x;
+}
+
+static comservatory::Contents read_range(const std::string& x, size_t skip, size_t max, int nthreads = 1) {
+    comservatory::ReadOptions opt;
+    opt.skip_records = skip;
+    opt.max_records = max;
+    opt.num_threads = nthreads;
+    return comservatory::read_buffer(x.c_str(), x.size(), opt);
+}
+
+static std::vector<double> first_column(const comservatory::Contents& contents) {
+    return static_cast<const comservatory::FilledNumberField*>(contents.fields[0].get())->values;
+}
+
+// Counts the number of bytes that were requested from the reader.
+struct CountingReader : public byteme::Reader {
+    CountingReader(const std::string& x) : contents(x) {}
+
+    size_t read(unsigned char* buffer, size_t n) {
+        n = std::min(n, contents.size() - total);
+        std::copy_n(contents.data() + total, n, buffer);
+        total += n;
+        return n;
+    }
+
+    const std::string& contents;
+    size_t total = 0;
+};
+
+TEST(RecordLimitTest, Buffer) {
+    auto x = mock_records(100);
+
+    auto out = read_range(x, 10, 5);
+    EXPECT_EQ(out.num_records(), 5);
+    EXPECT_EQ(first_column(out), (std::vector<double>{ 10, 11, 12, 13, 14 }));
+    auto sptr = static_cast<const comservatory::FilledStringField*>(out.fields[1].get());
+    EXPECT_EQ(sptr->values[0], "foo\n10");
+
+    // Same results with multiple threads.
+    compare_contents(out, read_range(x, 10, 5, 3));
+    compare_contents(read_range(x, 10, 50), read_range(x, 10, 50, 3));
+    compare_contents(read_range(x, 0, 50), read_range(x, 0, 50, 3));
+    compare_contents(read_range(x, 90, -1), read_range(x, 90, -1, 3));
+
+    // Handles limits beyond the end of the file.
+    EXPECT_EQ(read_range(x, 95, 100).num_records(), 5);
+    EXPECT_EQ(read_range(x, 100, 100).num_records(), 0);
+    EXPECT_EQ(read_range(x, 200, 100, 3).num_records(), 0);
+    EXPECT_EQ(read_range(x, 0, 0).num_records(), 0);
+    EXPECT_EQ(read_range(x, 0, 0, 3).num_records(), 0);
+
+    // Works for files without any fields.
+    std::string y = "\n\n\n\n";
+    EXPECT_EQ(read_range(y, 1, 100).num_records(), 2);
+    EXPECT_EQ(read_range(y, 0, 1).num_records(), 1);
+}
+
+TEST(RecordLimitTest, Streaming) {
+    auto x = mock_records(100000);
+
+    comservatory::ReadOptions opt;
+    opt.skip_records = 10;
+    opt.max_records = 5;
+    CountingReader reader(x);
+    auto out = comservatory::read(reader, opt);
+    EXPECT_EQ(first_column(out), (std::vector<double>{ 10, 11, 12, 13, 14 }));
+    EXPECT_LT(reader.total, x.size()); // i.e., we stopped reading early.
+
+    // Same for multiple threads.
+    opt.num_threads = 2;
+    CountingReader preader(x);
+    compare_contents(out, comservatory::read(preader, opt));
+    EXPECT_LT(preader.total, x.size());
+
+    // Same for visitors.
+    struct Collector : public comservatory::Visitor {
+        void number(size_t, double value) {
+            collected.push_back(value);
+        }
+        std::vector<double> collected;
+    };
+    Collector collector;
+    comservatory::visit_buffer(x.c_str(), x.size(), collector, opt);
+    EXPECT_EQ(collector.collected, first_column(out));
+
+    // Same for batches.
+    byteme::RawBufferReader breader(raw_bytes(x), x.size());
+    comservatory::BatchReader<byteme::RawBufferReader> batches(breader, 2, opt);
+    comservatory::Contents batch;
+    std::vector<double> batched;
+    while (batches.next(batch)) {
+        auto current = first_column(batch);
+        batched.insert(batched.end(), current.begin(), current.end());
+    }
+    EXPECT_EQ(batched, first_column(out));
+}
+
+TEST(RecordLimitTest, Validation) {
+    std::string x = "\"a\",\"b\"\n1,2\n\"foo\n\"\"bar\",3\n4,5\n6,\"whee\"\n";
+
+    // Skipped records are not validated, and neither are records after the limit.
+    auto out = read_range(x, 2, 1);
+    EXPECT_EQ(first_column(out), std::vector<double>{ 4 });
+
+    // Line numbers still count the skipped records.
+    EXPECT_ANY_THROW({
+        try {
+            read_range(x, 2, 10);
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("do not match"));
+            throw;
+        }
+    });
+
+    std::string y = "\"a\",\"b\"\n1,2\n3,4\n5\n";
+    EXPECT_ANY_THROW({
+        try {
+            read_range(y, 1, 10);
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("line 4 has fewer fields"));
+            throw;
+        }
+    });
+    EXPECT_ANY_THROW({
+        try {
+            read_range(y, 1, 10, 2);
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("line 4 has fewer fields"));
+            throw;
+        }
+    });
+}
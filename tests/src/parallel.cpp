@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "utils.h"
+#include "compare_contents.h"
+#include "byteme/byteme.hpp"
+
+#include <random>
+#include <string>
+
+static std::string mock_csv(size_t nrecords, size_t seed) {
+    std::mt19937_64 rng(seed);
+    std::string output = "\"num\",\"str\",\"bool\",\"cplx\",\"late\"\n";
+    for (size_t r = 0; r < nrecords; ++r) {
+        output += (rng() % 5 == 0 ? std::string("NA") : std::to_string(static_cast<double>(rng() % 10000) / 100)) + ",";
+
+        // Adding some multi-line strings with escaped quotes and commas.
+        switch (rng() % 4) {
+            case 0:
+                output += "NA,";
+                break;
+            case 1:
+                output += "\"foo\nbar " + std::to_string(r) + "\",";
+                break;
+            case 2:
+                output += "\"\"\"quoted\"\", with comma\",";
+                break;
+            default:
+                output += "\"plain\",";
+        }
+
+        output += (rng() % 2 ? "TRUE," : "false,");
+        output += std::to_string(rng() % 10) + "+" + std::to_string(rng() % 10) + "i,";
+
+        // This column is entirely missing until the very end.
+        output += (r + 1 == nrecords ? "\"last\"\n" : "NA\n");
+    }
+    return output;
+}
+
+static comservatory::Contents load_threads(const std::string& x, int nthreads, comservatory::ReadOptions opt = comservatory::ReadOptions()) {
+    byteme::RawBufferReader reader(raw_bytes(x), x.size());
+    opt.num_threads = nthreads;
+    return comservatory::read(reader, opt);
+}
+
+TEST(ParallelTest, Consistency) {
+    auto x = mock_csv(1000, 42);
+    byteme::RawBufferReader reader(raw_bytes(x), x.size());
+    auto ref = load_simple(reader);
+    EXPECT_EQ(ref.num_records(), 1000);
+    EXPECT_EQ(ref.fields[4]->type(), comservatory::STRING);
+
+    for (int t = 2; t <= 8; ++t) {
+        auto out = load_threads(x, t);
+        compare_contents(ref, out);
+    }
+}
+
+TEST(ParallelTest, LateResolution) {
+    // Only the last chunk contains non-missing values.
+    std::string x = "\"a\",\"b\"\n";
+    for (size_t i = 0; i < 100; ++i) {
+        x += "NA,1\n";
+    }
+    x += "\"foo\",2\n";
+
+    byteme::RawBufferReader reader(raw_bytes(x), x.size());
+    auto ref = load_simple(reader);
+    auto out = load_threads(x, 4);
+    compare_contents(ref, out);
+
+    auto sptr = static_cast<const comservatory::FilledStringField*>(out.fields[0].get());
+    EXPECT_EQ(sptr->missing.size(), 100);
+    EXPECT_EQ(sptr->values.back(), "foo");
+
+    // Still works if everything is missing.
+    std::string y = "\"a\",\"b\"\n";
+    for (size_t i = 0; i < 100; ++i) {
+        y += "NA,NA\n";
+    }
+    auto out2 = load_threads(y, 3);
+    EXPECT_EQ(out2.num_records(), 100);
+    EXPECT_EQ(out2.fields[0]->type(), comservatory::UNKNOWN);
+    EXPECT_EQ(out2.fields[1]->size(), 100);
+}
+
+TEST(ParallelTest, EdgeCases) {
+    // More threads than records.
+    std::string x = "\"a\",\"b\"\n1,\"x\ny\"\n";
+    byteme::RawBufferReader reader(raw_bytes(x), x.size());
+    auto ref = load_simple(reader);
+    compare_contents(ref, load_threads(x, 10));
+
+    // Header only.
+    auto header = load_threads("\"a\",\"b\"\n", 4);
+    EXPECT_EQ(header.num_fields(), 2);
+    EXPECT_EQ(header.num_records(), 0);
+
+    // Newline-only file.
+    auto empty = load_threads("\n\n\n", 4);
+    EXPECT_EQ(empty.num_fields(), 0);
+    EXPECT_EQ(empty.num_records(), 2);
+}
+
+TEST(ParallelTest, Options) {
+    auto x = mock_csv(500, 1);
+
+    comservatory::ReadOptions opt;
+    opt.keep_subset = true;
+    opt.keep_subset_indices = std::vector<int>{ 1, 3 };
+    auto subset = load_threads(x, 4, opt);
+    EXPECT_FALSE(subset.fields[0]->filled());
+    EXPECT_TRUE(subset.fields[1]->filled());
+    EXPECT_FALSE(subset.fields[2]->filled());
+    EXPECT_TRUE(subset.fields[3]->filled());
+    EXPECT_EQ(subset.fields[2]->size(), 500);
+
+    comservatory::ReadOptions vopt;
+    vopt.validate_only = true;
+    auto val = load_threads(x, 4, vopt);
+    for (const auto& f : val.fields) {
+        EXPECT_FALSE(f->filled());
+        EXPECT_EQ(f->size(), 500);
+    }
+
+    // Works with pre-filled fields.
+    comservatory::Contents contents;
+    contents.names = std::vector<std::string>{ "num", "str", "bool", "cplx", "late" };
+    contents.fields.emplace_back(new comservatory::FilledNumberField);
+    contents.fields.emplace_back(new comservatory::FilledStringField);
+    contents.fields.emplace_back(new comservatory::FilledBooleanField);
+    contents.fields.emplace_back(new comservatory::FilledComplexField);
+    contents.fields.emplace_back(new comservatory::FilledNumberField);
+
+    byteme::RawBufferReader reader(raw_bytes(x), x.size());
+    comservatory::ReadOptions popt;
+    popt.num_threads = 3;
+    EXPECT_ANY_THROW({
+        try {
+            comservatory::read(reader, contents, popt);
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("do not match"));
+            throw;
+        }
+    });
+}
+
+static void parallel_fail(const std::string& x, int nthreads, const std::string& msg) {
+    EXPECT_ANY_THROW({
+        try {
+            load_threads(x, nthreads);
+        } catch (std::exception& e) {
+            EXPECT_THAT(std::string(e.what()), ::testing::HasSubstr(msg));
+            throw;
+        }
+    });
+}
+
+TEST(ParallelTest, Errors) {
+    std::string x = "\"a\",\"b\"\n";
+    for (size_t i = 0; i < 100; ++i) {
+        if (i == 30) {
+            x += "1,2,3\n";
+        } else if (i == 80) {
+            x += "1,\n";
+        } else {
+            x += "1,2\n";
+        }
+    }
+
+    // Reports the earliest error, same as the serial parser.
+    parse_fail(x, "more fields on line 32");
+    for (int t = 2; t <= 8; ++t) {
+        parallel_fail(x, t, "more fields on line 32");
+    }
+
+    // Type mismatches across chunks.
+    std::string y = "\"a\",\"b\"\n";
+    for (size_t i = 0; i < 100; ++i) {
+        y += (i < 90 ? "1,2\n" : "1,\"foo\"\n");
+    }
+    y += "1,2,3\n";
+    parse_fail(y, "do not match");
+    for (int t = 2; t <= 8; ++t) {
+        parallel_fail(y, t, "do not match");
+    }
+
+    // Missing newline at the end.
+    parallel_fail("\"a\"\n1\n2\n3", 2, "terminated");
+}
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "utils.h"
+#include "compare_contents.h"
+#include "byteme/byteme.hpp"
+
+#include <string>
+#include <cstring>
+
+// A reader that also exposes its entire contents.
+struct ContiguousReader {
+    ContiguousReader(std::string x) : contents(std::move(x)) {}
+
+    size_t read(unsigned char* buffer, size_t n) {
+        n = std::min(n, contents.size() - position);
+        std::memcpy(buffer, contents.data() + position, n);
+        position += n;
+        return n;
+    }
+
+    const char* data() const {
+        return contents.data();
+    }
+
+    size_t size() const {
+        return contents.size();
+    }
+
+    std::string contents;
+    size_t position = 0;
+};
+
+TEST(ReadBufferTest, Basic) {
+    std::string x = "\"aaron\",\"britney\",\"chuck\",\"darth\"\n123,4.5e3+2.1i,\"asd\nasd\",TRUE\nNA,-1-4i,\"\"\"\",NA\n";
+    byteme::RawBufferReader reader(raw_bytes(x), x.size());
+    auto ref = load_simple(reader);
+
+    auto out = comservatory::read_buffer(x.c_str(), x.size(), comservatory::ReadOptions());
+    compare_contents(ref, out);
+
+    // Same results for readers with contiguous storage.
+    ContiguousReader creader(x);
+    compare_contents(ref, load_simple(creader));
+    EXPECT_EQ(creader.position, 0); // i.e., read() was never called.
+
+    // Works with multiple threads.
+    comservatory::ReadOptions opt;
+    opt.num_threads = 2;
+    compare_contents(ref, comservatory::read_buffer(x.c_str(), x.size(), opt));
+
+    // Works with subsetting.
+    comservatory::ReadOptions sopt;
+    sopt.keep_subset = true;
+    sopt.keep_subset_names = std::vector<std::string>{ "britney" };
+    auto subset = comservatory::read_buffer(x.c_str(), x.size(), sopt);
+    EXPECT_FALSE(subset.fields[0]->filled());
+    EXPECT_TRUE(subset.fields[1]->filled());
+}
+
+TEST(ReadBufferTest, Empty) {
+    EXPECT_ANY_THROW({
+        try {
+            comservatory::read_buffer(NULL, 0, comservatory::ReadOptions());
+        } catch (std::exception& e) {
+            EXPECT_THAT(e.what(), ::testing::HasSubstr("empty"));
+            throw;
+        }
+    });
+}
@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "utils.h"
+#include "compare_contents.h"
+#include "temp_file_path.h"
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+#if __has_include("zlib.h")
+#include "zlib.h"
+#endif
+
+class ReadRowsTest : public ::testing::Test {
+protected:
+    static std::string mock_records(size_t n) {
+        std::string x = "\"a\",\"b\",\"c\",\"d\"\n";
+        for (size_t i = 0; i < n; ++i) {
+            x += std::to_string(i) + ",\"foo\n" + std::to_string(i) + "\"," + (i % 2 ? "true" : "false") + ",";
+            x += (i < n / 2 ? std::string("NA") : std::to_string(i) + ".5");
+            x += "\n";
+        }
+        return x;
+    }
+
+    void SetUp() {
+        contents = mock_records(1000);
+        path = temp_file_path("comservatory-rows");
+        {
+            std::ofstream out(path, std::ios::binary);
+            out << contents;
+        }
+
+        index = comservatory::RecordIndex(17);
+        comservatory::ReadOptions opt;
+        opt.record_index = &index;
+        comservatory::read_file(path, opt);
+    }
+
+    // Using the types from the index, as fields might only contain missing values in some ranges.
+    comservatory::Contents reference(size_t begin, size_t end, const comservatory::RecordIndex& idx, comservatory::ReadOptions opt = comservatory::ReadOptions()) const {
+        comservatory::Contents output;
+        output.names = idx.names;
+        comservatory::DefaultFieldCreator<false> creator;
+        for (auto t : idx.types) {
+            output.fields.emplace_back(creator.create(t, 0, false));
+        }
+
+        opt.record_index = nullptr;
+        opt.skip_records = begin;
+        opt.max_records = end - begin;
+        comservatory::read_buffer(contents.c_str(), contents.size(), output, opt);
+        return output;
+    }
+
+    comservatory::Contents reference(size_t begin, size_t end) const {
+        return reference(begin, end, index);
+    }
+
+    std::string contents;
+    std::string path;
+    comservatory::RecordIndex index;
+};
+
+TEST_F(ReadRowsTest, Basic) {
+    EXPECT_EQ(index.names, (std::vector<std::string>{ "a", "b", "c", "d" }));
+    EXPECT_EQ(index.types, (std::vector<comservatory::Type>{ comservatory::NUMBER, comservatory::STRING, comservatory::BOOLEAN, comservatory::NUMBER }));
+
+    for (auto range : std::vector<std::pair<size_t, size_t> >{ { 0, 1 }, { 0, 17 }, { 5, 40 }, { 17, 18 }, { 123, 456 }, { 990, 1000 }, { 0, 1000 } }) {
+        auto out = comservatory::read_rows(path, index, range.first, range.second);
+        compare_contents(reference(range.first, range.second), out);
+    }
+
+    // Types are taken from the index, even if the requested records only contain missing values.
+    auto out = comservatory::read_rows(path, index, 10, 20);
+    EXPECT_EQ(out.fields[3]->type(), comservatory::NUMBER);
+    EXPECT_EQ(out.fields[3]->size(), 10);
+
+    // Empty ranges are allowed.
+    auto empty = comservatory::read_rows(path, index, 10, 10);
+    EXPECT_EQ(empty.num_fields(), 4);
+    EXPECT_EQ(empty.num_records(), 0);
+    EXPECT_EQ(empty.fields[0]->type(), comservatory::NUMBER);
+
+    // Works after a round trip through the sidecar.
+    auto sidecar = path + ".idx";
+    comservatory::save_record_index(index, sidecar);
+    auto loaded = comservatory::load_record_index(sidecar);
+    EXPECT_EQ(loaded.names, index.names);
+    EXPECT_EQ(loaded.types, index.types);
+    compare_contents(reference(500, 600), comservatory::read_rows(path, loaded, 500, 600));
+}
+
+TEST_F(ReadRowsTest, Options) {
+    comservatory::ReadOptions opt;
+    opt.keep_subset = true;
+    opt.keep_subset_indices = { 1 };
+    auto out = comservatory::read_rows(path, index, 100, 200, opt);
+    EXPECT_FALSE(out.fields[0]->filled());
+    EXPECT_TRUE(out.fields[1]->filled());
+    EXPECT_FALSE(out.fields[2]->filled());
+    EXPECT_EQ(out.num_records(), 100);
+
+    // Custom creators are respected.
+    struct MaskedCreator : public comservatory::FieldCreator {
+        comservatory::Field* create(comservatory::Type t, size_t n, bool dummy) const {
+            ++ncalls;
+            return creator.create(t, n, dummy);
+        }
+        comservatory::DefaultFieldCreator<false> creator{ false, false, true };
+        mutable int ncalls = 0;
+    };
+    MaskedCreator creator;
+    comservatory::ReadOptions copt;
+    copt.creator = &creator;
+    auto masked = comservatory::read_rows(path, index, 100, 200, copt);
+    EXPECT_EQ(creator.ncalls, 4);
+    EXPECT_NE(dynamic_cast<const comservatory::MaskedNumberField*>(masked.fields[0].get()), nullptr);
+    EXPECT_EQ(masked.num_records(), 100);
+
+    // Integers are detected if the index says so.
+    comservatory::RecordIndex iindex(17);
+    comservatory::ReadOptions iopt;
+    iopt.detect_integers = true;
+    iopt.record_index = &iindex;
+    comservatory::read_file(path, iopt);
+    EXPECT_EQ(iindex.types[0], comservatory::INTEGER);
+    EXPECT_EQ(iindex.types[3], comservatory::NUMBER);
+
+    auto ints = comservatory::read_rows(path, iindex, 100, 200);
+    EXPECT_EQ(ints.fields[0]->type(), comservatory::INTEGER);
+    compare_contents(reference(100, 200, iindex, iopt), ints);
+}
+
+TEST_F(ReadRowsTest, Errors) {
+    auto expect_error = [&](const comservatory::RecordIndex& idx, size_t begin, size_t end, const std::string& msg) -> void {
+        EXPECT_ANY_THROW({
+            try {
+                comservatory::read_rows(path, idx, begin, end);
+            } catch (std::exception& e) {
+                EXPECT_THAT(e.what(), ::testing::HasSubstr(msg));
+                throw;
+            }
+        });
+    };
+
+    expect_error(index, 10, 5, "out of range");
+    expect_error(index, 10, 1001, "out of range");
+
+    auto copy = index;
+    ++copy.size;
+    expect_error(copy, 10, 20, "does not match the size");
+
+    copy = index;
+    ++copy.offsets[1];
+    expect_error(copy, 20, 30, "does not match the contents");
+
+    // Values are still validated against the stored types.
+    copy = index;
+    copy.types[2] = comservatory::STRING;
+    expect_error(copy, 20, 30, "do not match up");
+}
+
+#if __has_include("zlib.h")
+TEST_F(ReadRowsTest, Gzip) {
+    auto gzpath = path + ".gz";
+    gzFile ohandle = gzopen(gzpath.c_str(), "w");
+    gzwrite(ohandle, contents.c_str(), contents.size());
+    gzclose(ohandle);
+
+    for (auto range : std::vector<std::pair<size_t, size_t> >{ { 0, 17 }, { 123, 456 }, { 990, 1000 } }) {
+        auto out = comservatory::read_rows(gzpath, index, range.first, range.second);
+        compare_contents(reference(range.first, range.second), out);
+    }
+}
+#endif
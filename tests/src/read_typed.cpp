@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "utils.h"
+#include "byteme/byteme.hpp"
+
+#include <string>
+#include <cmath>
+
+using comservatory::STRING;
+using comservatory::NUMBER;
+using comservatory::INTEGER;
+using comservatory::BOOLEAN;
+using comservatory::COMPLEX;
+
+TEST(ReadTypedTest, Basic) {
+    std::string x = "\"aaron\",\"britney\",\"chuck\",\"darth\",\"eric\"\n123,4.5e3+2.1i,\"asd\nasd\",TRUE,-5\nNA,-1-4i,\"\"\"\",NA,NA\n-Inf,NA,NA,false,9223372036854775807\n";
+    auto out = comservatory::read_typed_buffer<NUMBER, COMPLEX, STRING, BOOLEAN, INTEGER>(x.c_str(), x.size());
+    EXPECT_EQ(out.num_fields(), 5);
+    EXPECT_EQ(out.num_records(), 3);
+    EXPECT_EQ(out.names, (std::vector<std::string>{ "aaron", "britney", "chuck", "darth", "eric" }));
+
+    // Comparing to the dynamic parser.
+    auto ref = comservatory::read_buffer(x.c_str(), x.size(), comservatory::ReadOptions());
+
+    const auto& numbers = std::get<0>(out.fields);
+    auto rnumbers = static_cast<const comservatory::FilledNumberField*>(ref.fields[0].get());
+    EXPECT_EQ(numbers.values, rnumbers->values);
+    EXPECT_EQ(numbers.missing, rnumbers->missing);
+
+    const auto& complexes = std::get<1>(out.fields);
+    auto rcomplexes = static_cast<const comservatory::FilledComplexField*>(ref.fields[1].get());
+    EXPECT_EQ(complexes.values, rcomplexes->values);
+    EXPECT_EQ(complexes.missing, rcomplexes->missing);
+
+    const auto& strings = std::get<2>(out.fields);
+    auto rstrings = static_cast<const comservatory::FilledStringField*>(ref.fields[2].get());
+    EXPECT_EQ(strings.values, rstrings->values);
+    EXPECT_EQ(strings.missing, rstrings->missing);
+
+    const auto& booleans = std::get<3>(out.fields);
+    auto rbooleans = static_cast<const comservatory::FilledBooleanField*>(ref.fields[3].get());
+    EXPECT_EQ(booleans.values, rbooleans->values);
+    EXPECT_EQ(booleans.missing, rbooleans->missing);
+
+    const auto& integers = std::get<4>(out.fields);
+    EXPECT_EQ(integers.values, (std::vector<int64_t>{ -5, 0, 9223372036854775807 }));
+    EXPECT_EQ(integers.missing, std::vector<size_t>{ 1 });
+
+    // Same results from a reader.
+    byteme::RawBufferReader reader(raw_bytes(x), x.size());
+    auto out2 = comservatory::read_typed<NUMBER, COMPLEX, STRING, BOOLEAN, INTEGER>(reader);
+    EXPECT_EQ(std::get<0>(out2.fields).values, numbers.values);
+    EXPECT_EQ(std::get<2>(out2.fields).values, strings.values);
+    EXPECT_EQ(std::get<4>(out2.fields).values, integers.values);
+}
+
+TEST(ReadTypedTest, Special) {
+    std::string x = "\"a\",\"b\"\nNaN,\"x\"\n-nan,\"y\"\ninf,\"z\"\n";
+    auto out = comservatory::read_typed_buffer<NUMBER, STRING>(x.c_str(), x.size());
+    const auto& values = std::get<0>(out.fields).values;
+    EXPECT_TRUE(std::isnan(values[0]));
+    EXPECT_TRUE(std::isnan(values[1]));
+    EXPECT_EQ(values[2], std::numeric_limits<double>::infinity());
+
+    // Header-only files.
+    std::string y = "\"a\",\"b\"\n";
+    auto empty = comservatory::read_typed_buffer<NUMBER, STRING>(y.c_str(), y.size());
+    EXPECT_EQ(empty.num_records(), 0);
+    EXPECT_EQ(empty.names.size(), 2);
+
+    // Newline-only files.
+    std::string z = "\n\n\n";
+    auto newlines = comservatory::read_typed_buffer<>(z.c_str(), z.size());
+    EXPECT_EQ(newlines.num_records(), 2);
+}
+
+template<comservatory::Type... types>
+void typed_fail(const std::string& x, const std::string& msg) {
+    EXPECT_ANY_THROW({
+        try {
+            comservatory::read_typed_buffer<types...>(x.c_str(), x.size());
+        } catch (std::exception& e) {
+            EXPECT_THAT(std::string(e.what()), ::testing::HasSubstr(msg));
+            throw;
+        }
+    });
+
+    byteme::RawBufferReader reader(raw_bytes(x), x.size());
+    EXPECT_ANY_THROW({
+        try {
+            comservatory::read_typed<types...>(reader);
+        } catch (std::exception& e) {
+            EXPECT_THAT(std::string(e.what()), ::testing::HasSubstr(msg));
+            throw;
+        }
+    });
+}
+
+TEST(ReadTypedTest, Errors) {
+    // Same errors as the dynamic parser.
+    std::vector<std::string> invalid {
+        "\"a\",\"b\"\n1,2\n3\n",
+        "\"a\",\"b\"\n1,2\n3,4,5\n",
+        "\"a\",\"b\"\n1,2\n3,4,\"foo\"\n",
+        "\"a\",\"b\"\n1,2\n3,4",
+        "\"a\",\"b\"\n1,2\n3,",
+        "\"a\",\"b\"\n1,2\n3,4a\n",
+        "\"a\",\"b\"\n1,2\n3,\n",
+        "\"a\",\"b\"\n1,2\n3,4+\n",
+        "\"a\",\"b\"\n1,2\n3,4+5\n",
+        "\"a\",\"b\"\n1,2\n3,Nab\n",
+        "\"a\",\"b\"\n1,2\n3,x\n",
+        "\"a\",\"b\"\n1,2\n3,-\n",
+    };
+
+    for (const auto& x : invalid) {
+        std::string msg;
+        try {
+            comservatory::read_buffer(x.c_str(), x.size(), comservatory::ReadOptions());
+        } catch (std::exception& e) {
+            msg = e.what();
+        }
+        EXPECT_FALSE(msg.empty());
+        typed_fail<NUMBER, NUMBER>(x, msg);
+    }
+
+    typed_fail<NUMBER, STRING>("\"a\",\"b\"\n1,2\n", "do not match");
+    typed_fail<STRING, NUMBER>("\"a\",\"b\"\n1,2\n", "do not match");
+    typed_fail<NUMBER, BOOLEAN>("\"a\",\"b\"\n1,2\n", "do not match");
+    typed_fail<NUMBER, COMPLEX>("\"a\",\"b\"\n1,2\n", "do not match");
+    typed_fail<NUMBER, NUMBER>("\"a\",\"b\"\n1,2+1i\n", "do not match");
+    typed_fail<NUMBER, INTEGER>("\"a\",\"b\"\n1,2.5\n", "do not match");
+    typed_fail<NUMBER, INTEGER>("\"a\",\"b\"\n1,1e2\n", "do not match");
+    typed_fail<NUMBER, INTEGER>("\"a\",\"b\"\n1,NaN\n", "do not match");
+    typed_fail<NUMBER, INTEGER>("\"a\",\"b\"\n1,9223372036854775808\n", "do not match");
+    typed_fail<NUMBER>("\"a\",\"b\"\n1,2\n", "number of types");
+    typed_fail<NUMBER, NUMBER, NUMBER>("\"a\",\"b\"\n1,2\n", "number of types");
+}
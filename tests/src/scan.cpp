@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "comservatory/scan.hpp"
+
+#include <random>
+#include <string>
+#include <vector>
+
+static std::string random_csv_bytes(size_t n, size_t seed) {
+    std::mt19937_64 rng(seed);
+    const std::string alphabet = "\",\n\"abc,12\n";
+    std::string output(n, ' ');
+    for (auto& x : output) {
+        x = alphabet[rng() % alphabet.size()];
+    }
+    return output;
+}
+
+static std::vector<size_t> reference_boundaries(const std::string& x, bool in_quotes) {
+    std::vector<size_t> output;
+    for (size_t i = 0; i < x.size(); ++i) {
+        if (x[i] == '"') {
+            in_quotes = !in_quotes;
+        } else if (!in_quotes && (x[i] == ',' || x[i] == '\n')) {
+            output.push_back(i);
+        }
+    }
+    return output;
+}
+
+TEST(ScanTest, ClassifyBlock) {
+    auto x = random_csv_bytes(comservatory::scan_block_size * 10, 42);
+    for (size_t i = 0; i < x.size(); i += comservatory::scan_block_size) {
+        auto ref = comservatory::classify_block_scalar(x.data() + i);
+        auto obs = comservatory::classify_block(x.data() + i);
+        EXPECT_EQ(ref.quote, obs.quote);
+        EXPECT_EQ(ref.comma, obs.comma);
+        EXPECT_EQ(ref.newline, obs.newline);
+    }
+
+    // Partial blocks ignore everything past the end.
+    std::string y = "\",\n\"";
+    auto partial = comservatory::classify_partial_block(y.data(), 2);
+    EXPECT_EQ(partial.quote, 1u);
+    EXPECT_EQ(partial.comma, 2u);
+    EXPECT_EQ(partial.newline, 0u);
+}
+
+TEST(ScanTest, PrefixXor) {
+    EXPECT_EQ(comservatory::prefix_xor(0), 0u);
+    EXPECT_EQ(comservatory::prefix_xor(0b1001), 0b0111u);
+    EXPECT_EQ(comservatory::prefix_xor(0b11), 0b01u); // escaped quotes are a no-op.
+    EXPECT_EQ(comservatory::prefix_xor(1), ~static_cast<uint64_t>(0));
+}
+
+TEST(ScanTest, Boundaries) {
+    std::string x = "\"a,b\",\"c\nd\"\n1,2\n\"e\"\"\",NA\n";
+    std::vector<size_t> obs;
+    EXPECT_FALSE(comservatory::find_boundaries(x.data(), x.size(), obs));
+    EXPECT_EQ(obs, reference_boundaries(x, false));
+
+    for (size_t n : { 10, 63, 64, 65, 200, 1000 }) {
+        for (int quoted = 0; quoted < 2; ++quoted) {
+            auto y = random_csv_bytes(n, n + quoted);
+            std::vector<size_t> obs;
+            comservatory::find_boundaries(y.data(), y.size(), obs, quoted);
+            EXPECT_EQ(obs, reference_boundaries(y, quoted));
+        }
+    }
+}
+
+TEST(ScanTest, BoundariesInPieces) {
+    auto x = random_csv_bytes(1000, 1);
+    auto ref = reference_boundaries(x, false);
+
+    std::vector<size_t> obs;
+    bool in_quotes = false;
+    for (size_t start = 0; start < x.size(); start += 77) {
+        size_t len = std::min(static_cast<size_t>(77), x.size() - start);
+        in_quotes = comservatory::find_boundaries(x.data() + start, len, obs, in_quotes, start);
+    }
+    EXPECT_EQ(obs, ref);
+}
+
+TEST(ScanTest, RecordEnd) {
+    std::string x = "\"a\nb\",1\n2,3\n";
+    auto start = x.data(), end = x.data() + x.size();
+    EXPECT_EQ(comservatory::find_record_end(start, end) - start, 7);
+    EXPECT_EQ(comservatory::find_record_end(start + 2, end, true) - start, 7);
+    EXPECT_EQ(comservatory::find_record_end(start + 2, end, false) - start, 2);
+    EXPECT_EQ(comservatory::find_record_end(start, start + 5), start + 5);
+
+    auto y = random_csv_bytes(500, 2);
+    auto ref = reference_boundaries(y, false);
+    size_t expected = y.size();
+    for (auto r : ref) {
+        if (y[r] == '\n') {
+            expected = r;
+            break;
+        }
+    }
+    EXPECT_EQ(comservatory::find_record_end(y.data(), y.data() + y.size()) - y.data(), expected);
+}
+
+TEST(ScanTest, Counting) {
+    auto x = random_csv_bytes(1000, 3);
+    size_t nquotes = 0;
+    for (auto c : x) {
+        nquotes += (c == '"');
+    }
+    EXPECT_EQ(comservatory::count_quotes(x.data(), x.data() + x.size()), nquotes);
+
+    for (int quoted = 0; quoted < 2; ++quoted) {
+        size_t nrecords = 0;
+        for (auto r : reference_boundaries(x, quoted)) {
+            nrecords += (x[r] == '\n');
+        }
+        EXPECT_EQ(comservatory::count_records(x.data(), x.data() + x.size(), quoted), nrecords);
+    }
+}
@@ -65,6 +65,16 @@ inline void parse_fail(const std::string& x, const std::string& msg) {
             throw;
         }
     });
+
+    // Same behavior when parsing the buffer directly.
+    EXPECT_ANY_THROW({
+        try {
+            comservatory::read_buffer(x.c_str(), x.size(), comservatory::ReadOptions());
+        } catch (std::exception& e) {
+            EXPECT_THAT(std::string(e.what()), ::testing::HasSubstr(msg));
+            throw;
+        }
+    });
 }
 
 inline void simple_conversion_fail(std::string x, const std::string& msg) {
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "utils.h"
+#include "compare_contents.h"
+#include "byteme/byteme.hpp"
+
+#include <string>
+#include <vector>
+
+static comservatory::Contents read_with_level(const std::string& x, comservatory::ValidationLevel level, bool validate_only = false) {
+    comservatory::ReadOptions opt;
+    opt.dummy_validation = level;
+    opt.detect_integers = true;
+    if (validate_only) {
+        opt.validate_only = true;
+    } else {
+        opt.keep_subset = true;
+        opt.keep_subset_indices = std::vector<int>{ 0 };
+    }
+    return comservatory::read_buffer(x.c_str(), x.size(), opt);
+}
+
+static std::string error_with_level(const std::string& x, comservatory::ValidationLevel level, bool validate_only = false) {
+    try {
+        read_with_level(x, level, validate_only);
+    } catch (std::exception& e) {
+        return e.what();
+    }
+    return "";
+}
+
+TEST(ValidationTest, Grammar) {
+    std::string x = "\"a\",\"b\",\"c\",\"d\"\n1,2.5,\"foo\",1+2i\n2,NA,\"bar\"\"\",-3e-5-1.5i\n3,-1e+300,NA,NA\n";
+    auto full = read_with_level(x, comservatory::ValidationLevel::FULL);
+    auto grammar = read_with_level(x, comservatory::ValidationLevel::GRAMMAR);
+    EXPECT_EQ(grammar.num_records(), 3);
+    for (size_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(grammar.fields[i]->type(), full.fields[i]->type());
+        EXPECT_EQ(grammar.fields[i]->size(), full.fields[i]->size());
+    }
+    EXPECT_TRUE(grammar.fields[0]->filled());
+    EXPECT_FALSE(grammar.fields[1]->filled());
+
+    auto nptr = static_cast<const comservatory::FilledIntegerField*>(grammar.fields[0].get());
+    EXPECT_EQ(nptr->values, (std::vector<int64_t>{ 1, 2, 3 }));
+
+    // Integer promotion still works.
+    std::string y = "\"a\",\"b\"\n1,2\n2,3.5\n3,4\n";
+    auto promoted = read_with_level(y, comservatory::ValidationLevel::GRAMMAR);
+    EXPECT_EQ(promoted.fields[1]->type(), comservatory::NUMBER);
+}
+
+TEST(ValidationTest, GrammarErrors) {
+    // Same errors as full validation, once the type of the dummy field is known.
+    std::vector<std::string> values {
+        "10",
+        "10L\n",
+        "10.\n",
+        "10.a\n",
+        "10.1a\n",
+        "10.0.0\n",
+        "10e1\n",
+        "0.5e1\n",
+        "1e\n",
+        "1e+\n",
+        "1e+a\n",
+        "1e+1a",
+        "2e1.1",
+        "+a\n",
+        "-x\n",
+        "1+\n",
+        "1+2\n",
+        "1+2x\n",
+        "1-ai\n",
+        "\"foo\"\n",
+        "TRUE\n",
+        "Na\n",
+        "1+2i\n",
+    };
+
+    for (const auto& v : values) {
+        std::string x = "\"a\",\"b\"\n1,1\n2," + v;
+        auto msg = error_with_level(x, comservatory::ValidationLevel::FULL);
+        EXPECT_FALSE(msg.empty());
+        EXPECT_EQ(error_with_level(x, comservatory::ValidationLevel::GRAMMAR), msg);
+        EXPECT_EQ(error_with_level(x, comservatory::ValidationLevel::GRAMMAR, true), msg);
+    }
+
+    std::vector<std::string> strings {
+        "\"foo",
+        "\"foo\"",
+        "\"foo\"\"\n",
+        "\"foo\"x\n",
+        "1\n",
+    };
+
+    for (const auto& v : strings) {
+        std::string x = "\"a\",\"b\"\n1,\"x\"\n2," + v;
+        auto msg = error_with_level(x, comservatory::ValidationLevel::FULL);
+        EXPECT_FALSE(msg.empty());
+        EXPECT_EQ(error_with_level(x, comservatory::ValidationLevel::GRAMMAR), msg);
+    }
+}
+
+TEST(ValidationTest, Structure) {
+    std::string x = "\"a\",\"b\",\"c\"\n1,2.5,\"foo\"\n2,NA,\"b,a\nr\"\"\"\n3,-1e+300,NA\n";
+    auto full = read_with_level(x, comservatory::ValidationLevel::FULL);
+    auto structure = read_with_level(x, comservatory::ValidationLevel::STRUCTURE);
+    EXPECT_EQ(structure.num_records(), 3);
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_EQ(structure.fields[i]->type(), full.fields[i]->type());
+        EXPECT_EQ(structure.fields[i]->size(), full.fields[i]->size());
+    }
+
+    auto nptr = static_cast<const comservatory::FilledIntegerField*>(structure.fields[0].get());
+    EXPECT_EQ(nptr->values, (std::vector<int64_t>{ 1, 2, 3 }));
+
+    // Values are not checked after the type is determined.
+    std::string y = "\"a\",\"b\"\n1,1\n2,\"foo\"\n3,1x\n";
+    EXPECT_EQ(read_with_level(y, comservatory::ValidationLevel::STRUCTURE).num_records(), 3);
+    EXPECT_THAT(error_with_level(y, comservatory::ValidationLevel::GRAMMAR), ::testing::HasSubstr("do not match"));
+
+    // But the structure still is.
+    EXPECT_THAT(error_with_level("\"a\",\"b\"\n1,1\n2,\n", comservatory::ValidationLevel::STRUCTURE), ::testing::HasSubstr("is empty"));
+    EXPECT_THAT(error_with_level("\"a\",\"b\"\n1,1\n2,,\n", comservatory::ValidationLevel::STRUCTURE), ::testing::HasSubstr("unknown type starting with ','"));
+    EXPECT_THAT(error_with_level("\"a\",\"b\"\n1,1\n2,\"foo\n", comservatory::ValidationLevel::STRUCTURE), ::testing::HasSubstr("truncated string"));
+    EXPECT_THAT(error_with_level("\"a\",\"b\"\n1,1\n2,1", comservatory::ValidationLevel::STRUCTURE), ::testing::HasSubstr("terminated by a single newline"));
+    EXPECT_THAT(error_with_level("\"a\",\"b\"\n1,1\n2,1,2\n", comservatory::ValidationLevel::STRUCTURE), ::testing::HasSubstr("more fields"));
+    EXPECT_THAT(error_with_level("\"a\",\"b\",\"c\"\n1,1,1\n2,1\n", comservatory::ValidationLevel::STRUCTURE), ::testing::HasSubstr("fewer fields"));
+
+    // Same results for streaming inputs.
+    byteme::RawBufferReader reader(raw_bytes(x), x.size());
+    comservatory::ReadOptions opt;
+    opt.validate_only = true;
+    opt.dummy_validation = comservatory::ValidationLevel::STRUCTURE;
+    auto streamed = comservatory::read(reader, opt);
+    EXPECT_EQ(streamed.num_records(), 3);
+}
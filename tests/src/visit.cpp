@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "utils.h"
+#include "temp_file_path.h"
+#include "byteme/byteme.hpp"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Records each event as a string for easy comparisons.
+struct RecordingVisitor : public comservatory::Visitor {
+    void header(const std::vector<std::string>& names) {
+        for (const auto& n : names) {
+            events.push_back("header:" + n);
+        }
+    }
+
+    void string(size_t column, std::string_view value) {
+        events.push_back(std::to_string(column) + ":string:" + std::string(value));
+    }
+
+    void number(size_t column, double value) {
+        events.push_back(std::to_string(column) + ":number:" + std::to_string(value));
+    }
+
+    void integer(size_t column, int64_t value) {
+        events.push_back(std::to_string(column) + ":integer:" + std::to_string(value));
+    }
+
+    void complex(size_t column, std::complex<double> value) {
+        events.push_back(std::to_string(column) + ":complex:" + std::to_string(value.real()) + "," + std::to_string(value.imag()));
+    }
+
+    void missing(size_t column) {
+        events.push_back(std::to_string(column) + ":missing");
+    }
+
+    void record(size_t line) {
+        events.push_back("record:" + std::to_string(line));
+    }
+
+    std::vector<std::string> events;
+};
+
+// Only overrides some of the events.
+struct CountingVisitor : public comservatory::Visitor {
+    void number(size_t, double value) {
+        total += value;
+    }
+
+    void record(size_t) {
+        ++nrecords;
+    }
+
+    double total = 0;
+    size_t nrecords = 0;
+};
+
+TEST(VisitTest, Basic) {
+    std::string x = "\"aaron\",\"britney\",\"chuck\",\"darth\"\n123,4.5e3+2.1i,\"asd\nasd\",TRUE\nNA,-1-4i,\"\"\"\",NA\n";
+
+    RecordingVisitor visitor;
+    comservatory::visit_buffer(x.c_str(), x.size(), visitor, comservatory::ReadOptions());
+    std::vector<std::string> expected {
+        "header:aaron",
+        "header:britney",
+        "header:chuck",
+        "header:darth",
+        "0:number:123.000000",
+        "1:complex:4500.000000,2.100000",
+        "2:string:asd\nasd",
+        "record:1",
+        "0:missing",
+        "1:complex:-1.000000,-4.000000",
+        "2:string:\"",
+        "3:missing",
+        "record:2"
+    };
+    EXPECT_EQ(visitor.events, expected);
+
+    // Same results from a streaming reader.
+    byteme::RawBufferReader reader(raw_bytes(x), x.size());
+    RecordingVisitor visitor2;
+    comservatory::visit(reader, visitor2, comservatory::ReadOptions());
+    EXPECT_EQ(visitor2.events, expected);
+
+    comservatory::ReadOptions popt;
+    popt.parallel = true;
+    byteme::RawBufferReader preader(raw_bytes(x), x.size());
+    RecordingVisitor visitor3;
+    comservatory::visit(preader, visitor3, popt);
+    EXPECT_EQ(visitor3.events, expected);
+}
+
+TEST(VisitTest, Partial) {
+    std::string x = "\"a\",\"b\"\n1,\"x\"\n2.5,\"y\"\nNA,\"z\"\n";
+    CountingVisitor visitor;
+    comservatory::visit_buffer(x.c_str(), x.size(), visitor, comservatory::ReadOptions());
+    EXPECT_EQ(visitor.total, 3.5);
+    EXPECT_EQ(visitor.nrecords, 3);
+
+    // Header-only files.
+    std::string y = "\"a\",\"b\"\n";
+    RecordingVisitor hvisitor;
+    comservatory::visit_buffer(y.c_str(), y.size(), hvisitor, comservatory::ReadOptions());
+    EXPECT_EQ(hvisitor.events, (std::vector<std::string>{ "header:a", "header:b" }));
+}
+
+TEST(VisitTest, Integers) {
+    std::string x = "\"a\"\n1\n-2\n3.5\n4\n";
+    comservatory::ReadOptions opt;
+    opt.detect_integers = true;
+    RecordingVisitor visitor;
+    comservatory::visit_buffer(x.c_str(), x.size(), visitor, opt);
+
+    std::vector<std::string> expected {
+        "header:a",
+        "0:integer:1",
+        "record:1",
+        "0:integer:-2",
+        "record:2",
+        "0:number:3.500000",
+        "record:3",
+        "0:number:4.000000",
+        "record:4"
+    };
+    EXPECT_EQ(visitor.events, expected);
+}
+
+TEST(VisitTest, File) {
+    std::string x = "\"a\",\"b\"\n1,\"x\"\n2.5,\"y\"\n";
+    auto path = temp_file_path("comservatory-visit");
+    {
+        std::ofstream out(path);
+        out << x;
+    }
+
+    RecordingVisitor ref;
+    comservatory::visit_buffer(x.c_str(), x.size(), ref, comservatory::ReadOptions());
+
+    RecordingVisitor visitor;
+    comservatory::visit_file(path, visitor, comservatory::ReadOptions());
+    EXPECT_EQ(visitor.events, ref.events);
+
+    comservatory::ReadOptions opt;
+    opt.memory_map = true;
+    RecordingVisitor mvisitor;
+    comservatory::visit_file(path, mvisitor, opt);
+    EXPECT_EQ(mvisitor.events, ref.events);
+}
+
+TEST(VisitTest, Errors) {
+    // Same errors as the Parser.
+    std::vector<std::string> invalid {
+        "",
+        "\"a\",\"a\"\n",
+        "\"a\",\"b\"\n1,2\n3\n",
+        "\"a\",\"b\"\n1,2\n3,4,5\n",
+        "\"a\",\"b\"\n1,2\n3,4,\"foo\"\n",
+        "\"a\",\"b\"\n1,2\n3,4",
+        "\"a\",\"b\"\n1,2\n3,",
+        "\"a\",\"b\"\n1,2\n3,4a\n",
+        "\"a\",\"b\"\n1,2\n3,\n",
+        "\"a\",\"b\"\n1,2\n3,\"foo\"\n",
+        "\"a\",\"b\"\n1,2\n3,true\n",
+        "\"a\",\"b\"\n1,2\n3,4+1i\n",
+        "\"a\",\"b\"\n1,2\n3,Nab\n",
+    };
+
+    for (const auto& x : invalid) {
+        std::string msg;
+        try {
+            comservatory::read_buffer(x.c_str(), x.size(), comservatory::ReadOptions());
+        } catch (std::exception& e) {
+            msg = e.what();
+        }
+        EXPECT_FALSE(msg.empty());
+
+        EXPECT_ANY_THROW({
+            try {
+                CountingVisitor visitor;
+                comservatory::visit_buffer(x.c_str(), x.size(), visitor, comservatory::ReadOptions());
+            } catch (std::exception& e) {
+                EXPECT_EQ(std::string(e.what()), msg);
+                throw;
+            }
+        });
+
+        EXPECT_ANY_THROW({
+            try {
+                CountingVisitor visitor;
+                byteme::RawBufferReader reader(raw_bytes(x), x.size());
+                comservatory::visit(reader, visitor, comservatory::ReadOptions());
+            } catch (std::exception& e) {
+                EXPECT_EQ(std::string(e.what()), msg);
+                throw;
+            }
+        });
+    }
+}
@@ -0,0 +1,229 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "utils.h"
+#include "compare_contents.h"
+#include "temp_file_path.h"
+
+#include <string>
+#include <cmath>
+#include <limits>
+
+static std::string mock_records(size_t n) {
+    std::string x = "\"str\",\"num\",\"int\",\"bool\",\"cplx\",\"unk\"\n";
+    for (size_t i = 0; i < n; ++i) {
+        x += (i % 5 == 0 ? std::string("NA") : "\"foo\"\"" + std::to_string(i) + "\"\"\nbar,\"") + ",";
+        x += (i % 7 == 0 ? std::string("NA") : std::to_string(i % 9 + 1) + "." + std::to_string(i) + "e-" + std::to_string(i % 10)) + ",";
+        x += (i % 3 == 0 ? std::string("NA") : "-" + std::to_string(i * 1000)) + ",";
+        x += (i % 11 == 0 ? "NA" : (i % 2 ? "true" : "FALSE")) + std::string(",");
+        x += (i % 13 == 0 ? std::string("NA") : "1.5-" + std::to_string(i) + "i") + ",NA\n";
+    }
+    return x;
+}
+
+static comservatory::Contents read_string(const std::string& x, comservatory::ReadOptions opt = comservatory::ReadOptions()) {
+    opt.detect_integers = true;
+    return comservatory::read_buffer(x.c_str(), x.size(), opt);
+}
+
+TEST(WriteTest, RoundTrip) {
+    auto x = mock_records(1000);
+    auto ref = read_string(x);
+    ASSERT_EQ(ref.fields[2]->type(), comservatory::INTEGER);
+    ASSERT_EQ(ref.fields[5]->type(), comservatory::UNKNOWN);
+
+    comservatory::WriteOptions wopt;
+    auto y = comservatory::write_buffer(ref, wopt);
+    compare_contents(ref, read_string(y));
+
+    // Output is identical regardless of the number of threads.
+    wopt.chunk_records = 77;
+    for (int nthreads : { 1, 3, 8 }) {
+        wopt.num_threads = nthreads;
+        EXPECT_EQ(comservatory::write_buffer(ref, wopt), y);
+    }
+}
+
+TEST(WriteTest, FieldClasses) {
+    auto x = mock_records(500);
+    auto ref = read_string(x);
+    auto y = comservatory::write_buffer(ref, comservatory::WriteOptions());
+
+    comservatory::ReadOptions ropt;
+    ropt.arena_strings = true;
+    ropt.missing_bitmap = true;
+    auto arena = read_string(x, ropt);
+    EXPECT_NE(dynamic_cast<comservatory::ArenaStringField*>(arena.fields[0].get()), nullptr);
+    EXPECT_NE(dynamic_cast<comservatory::MaskedNumberField*>(arena.fields[1].get()), nullptr);
+
+    comservatory::WriteOptions wopt;
+    wopt.chunk_records = 33;
+    wopt.num_threads = 3;
+    EXPECT_EQ(comservatory::write_buffer(arena, wopt), y);
+
+    ropt = comservatory::ReadOptions();
+    ropt.string_views = true;
+    auto views = read_string(x, ropt);
+    EXPECT_NE(dynamic_cast<comservatory::StringViewField*>(views.fields[0].get()), nullptr);
+    EXPECT_EQ(comservatory::write_buffer(views, wopt), y);
+
+    ropt.string_views = false;
+    ropt.missing_bitmap = true;
+    auto masked = read_string(x, ropt);
+    EXPECT_NE(dynamic_cast<comservatory::MaskedStringField*>(masked.fields[0].get()), nullptr);
+    EXPECT_EQ(comservatory::write_buffer(masked, wopt), y);
+}
+
+static comservatory::Contents single_number(std::vector<double> values) {
+    comservatory::Contents contents;
+    contents.names.push_back("x");
+    auto field = new comservatory::FilledNumberField;
+    field->values = std::move(values);
+    contents.fields.emplace_back(field);
+    return contents;
+}
+
+TEST(WriteTest, Numbers) {
+    auto contents = single_number({ 0.1, 1e300, -2.5e-300, 123456789.0, -0.0, 5e-324 });
+    auto y = comservatory::write_buffer(contents, comservatory::WriteOptions());
+    EXPECT_EQ(y, "\"x\"\n0.1\n1e+300\n-2.5e-300\n123456789\n-0\n5e-324\n");
+
+    // Shortest representation still round-trips exactly.
+    auto roundtrip = read_string(y);
+    compare_contents(contents, roundtrip);
+
+    auto special = single_number({ std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity() });
+    static_cast<comservatory::FilledNumberField*>(special.fields[0].get())->missing.push_back(1);
+    y = comservatory::write_buffer(special, comservatory::WriteOptions());
+    EXPECT_EQ(y, "\"x\"\nnan\nNA\n-inf\n");
+
+    auto reread = read_string(y);
+    auto field = static_cast<comservatory::FilledNumberField*>(reread.fields[0].get());
+    EXPECT_TRUE(std::isnan(field->values[0]));
+    EXPECT_EQ(field->missing, std::vector<size_t>{ 1 });
+    EXPECT_EQ(field->values[2], -std::numeric_limits<double>::infinity());
+}
+
+TEST(WriteTest, Strings) {
+    comservatory::Contents contents;
+    contents.names.push_back("a\"b");
+    auto field = new comservatory::FilledStringField;
+    field->values = std::vector<std::string>{ "", "\"", "NA", "a,b\nc", "\"\"x\"" };
+    contents.fields.emplace_back(field);
+
+    auto y = comservatory::write_buffer(contents, comservatory::WriteOptions());
+    EXPECT_EQ(y, "\"a\"\"b\"\n\"\"\n\"\"\"\"\n\"NA\"\n\"a,b\nc\"\n\"\"\"\"\"x\"\"\"\n");
+    compare_contents(contents, read_string(y));
+}
+
+TEST(WriteTest, Empty) {
+    comservatory::Contents contents;
+    EXPECT_EQ(comservatory::write_buffer(contents, comservatory::WriteOptions()), "\n");
+
+    // Records without any fields are written as empty lines.
+    auto empty = read_string("\n\n\n\n");
+    EXPECT_EQ(empty.num_records(), 3);
+    EXPECT_EQ(comservatory::write_buffer(empty, comservatory::WriteOptions()), "\n\n\n\n");
+
+    // Fields without any records.
+    auto x = mock_records(0);
+    EXPECT_EQ(comservatory::write_buffer(read_string(x), comservatory::WriteOptions()), x);
+}
+
+TEST(WriteTest, File) {
+    auto x = mock_records(2000);
+    auto ref = read_string(x);
+    auto path = temp_file_path("comservatory-write");
+
+    comservatory::WriteOptions wopt;
+    wopt.chunk_records = 100;
+    wopt.num_threads = 2;
+    comservatory::write_file(ref, path, wopt);
+    comservatory::ReadOptions ropt;
+    ropt.detect_integers = true;
+    compare_contents(ref, comservatory::read_file(path, ropt));
+
+#if __has_include("zlib.h")
+    auto gzpath = temp_file_path("comservatory-write-gz");
+    wopt.gzip = true;
+    comservatory::write_file(ref, gzpath, wopt);
+    EXPECT_TRUE(byteme::is_gzip(gzpath.c_str()));
+    compare_contents(ref, comservatory::read_file(gzpath, ropt));
+#endif
+}
+
+TEST(WriteTest, Batches) {
+    auto x = mock_records(1000);
+    auto ref = read_string(x);
+
+    struct StringWriter {
+        void write(const char* data, size_t n) {
+            output.append(data, n);
+        }
+        std::string output;
+    };
+
+    StringWriter writer;
+    comservatory::BatchWriter<StringWriter> batcher(writer, ref.names, comservatory::WriteOptions());
+    byteme::RawBufferReader reader(raw_bytes(x), x.size());
+    comservatory::ReadOptions ropt;
+    ropt.detect_integers = true;
+    comservatory::BatchReader batches(reader, 128, ropt);
+
+    comservatory::Contents batch;
+    while (batches.next(batch)) {
+        batcher.write(batch);
+    }
+    EXPECT_EQ(writer.output, comservatory::write_buffer(ref, comservatory::WriteOptions()));
+
+    // Type is checked across batches.
+    auto other = read_string("\"str\",\"num\",\"int\",\"bool\",\"cplx\",\"unk\"\n1,2,3,4,5,6\n");
+    EXPECT_ANY_THROW({
+        try {
+            batcher.write(other);
+        } catch (std::exception& e) {
+            EXPECT_THAT(std::string(e.what()), ::testing::HasSubstr("differs from previous batches"));
+            throw;
+        }
+    });
+
+    other.names[0] = "foo";
+    EXPECT_ANY_THROW({
+        try {
+            batcher.write(other);
+        } catch (std::exception& e) {
+            EXPECT_THAT(std::string(e.what()), ::testing::HasSubstr("should be the same"));
+            throw;
+        }
+    });
+}
+
+static void write_fail(const comservatory::Contents& contents, const std::string& msg) {
+    EXPECT_ANY_THROW({
+        try {
+            comservatory::write_buffer(contents, comservatory::WriteOptions());
+        } catch (std::exception& e) {
+            EXPECT_THAT(std::string(e.what()), ::testing::HasSubstr(msg));
+            throw;
+        }
+    });
+}
+
+TEST(WriteTest, Errors) {
+    auto contents = single_number({ 1, 2 });
+    contents.names.push_back("y");
+    contents.fields.emplace_back(new comservatory::FilledStringField(1));
+    write_fail(contents, "same number of records");
+
+    contents.fields.back().reset(new comservatory::DummyStringField(2));
+    write_fail(contents, "does not contain any values");
+
+    comservatory::Contents complex;
+    complex.names.push_back("z");
+    auto field = new comservatory::FilledComplexField;
+    field->values.emplace_back(1, std::numeric_limits<double>::infinity());
+    complex.fields.emplace_back(field);
+    write_fail(complex, "non-finite");
+
+    EXPECT_ANY_THROW(comservatory::write_file(single_number({ 1 }), "missing-directory/foo.csv"));
+}